@@ -0,0 +1,43 @@
+/*
+ * Copyright 2026 International Digital Economy Academy
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "buffer_pool.h"
+
+#include "loop.h"
+#include "moonbit.h"
+#include "uv#include#uv.h"
+#include "uv.h"
+
+MOONBIT_FFI_EXPORT
+void
+moonbit_uv_loop_read_pool_stats(uv_loop_t *loop, uint64_t *stats) {
+  moonbit_uv_loop_data_t *data = loop->data;
+  if (data) {
+    moonbit_uv_buffer_pool_t *pool = &data->read_pool;
+    uint64_t idle = 0;
+    for (int32_t i = 0; i < MOONBIT_UV_BUFFER_POOL_CLASSES; i++) {
+      idle += pool->classes[i].count;
+    }
+    stats[0] = pool->hits;
+    stats[1] = pool->misses;
+    stats[2] = pool->retained;
+    stats[3] = pool->in_use;
+    stats[4] = pool->high_water;
+    stats[5] = idle;
+  }
+  moonbit_decref(loop);
+  moonbit_decref(stats);
+}
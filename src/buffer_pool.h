@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026 International Digital Economy Academy
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MOONBIT_UV_BUFFER_POOL_H
+#define MOONBIT_UV_BUFFER_POOL_H
+
+#include "moonbit.h"
+
+#include "uv.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Buffers are handed out in power-of-two size classes from 4 KiB to 64 KiB.
+#define MOONBIT_UV_BUFFER_POOL_MIN_SHIFT 12
+#define MOONBIT_UV_BUFFER_POOL_MAX_SHIFT 16
+#define MOONBIT_UV_BUFFER_POOL_CLASSES                                         \
+  (MOONBIT_UV_BUFFER_POOL_MAX_SHIFT - MOONBIT_UV_BUFFER_POOL_MIN_SHIFT + 1)
+
+// Maximum number of idle buffers kept per size class.
+#define MOONBIT_UV_BUFFER_POOL_CAPACITY 64
+
+typedef struct moonbit_uv_buffer_pool_class_s {
+  int32_t count;
+  moonbit_bytes_t free[MOONBIT_UV_BUFFER_POOL_CAPACITY];
+} moonbit_uv_buffer_pool_class_t;
+
+typedef struct moonbit_uv_buffer_pool_s {
+  moonbit_uv_buffer_pool_class_t classes[MOONBIT_UV_BUFFER_POOL_CLASSES];
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t retained;
+  uint64_t in_use;
+  uint64_t high_water;
+} moonbit_uv_buffer_pool_t;
+
+static inline int32_t
+moonbit_uv_buffer_pool_class(size_t size) {
+  int32_t index = 0;
+  while (index < MOONBIT_UV_BUFFER_POOL_CLASSES - 1 &&
+         ((size_t)1 << (index + MOONBIT_UV_BUFFER_POOL_MIN_SHIFT)) < size) {
+    index++;
+  }
+  return index;
+}
+
+static inline int32_t
+moonbit_uv_buffer_pool_class_size(int32_t index) {
+  return (int32_t)1 << (index + MOONBIT_UV_BUFFER_POOL_MIN_SHIFT);
+}
+
+static inline moonbit_bytes_t
+moonbit_uv_buffer_pool_acquire(moonbit_uv_buffer_pool_t *pool, int32_t index) {
+  moonbit_uv_buffer_pool_class_t *size_class = &pool->classes[index];
+  moonbit_bytes_t bytes;
+  if (size_class->count > 0) {
+    bytes = size_class->free[--size_class->count];
+    pool->hits++;
+  } else {
+    bytes = moonbit_make_bytes(moonbit_uv_buffer_pool_class_size(index), 0);
+    pool->misses++;
+  }
+  pool->in_use++;
+  if (pool->in_use > pool->high_water) {
+    pool->high_water = pool->in_use;
+  }
+  return bytes;
+}
+
+// Gives `bytes` back to the pool. The pool only keeps the buffer when it holds
+// the last reference to it; a buffer that is still referenced from MoonBit
+// (for example, because a read callback kept the view) is left to RC.
+static inline void
+moonbit_uv_buffer_pool_release(
+  moonbit_uv_buffer_pool_t *pool,
+  moonbit_bytes_t bytes
+) {
+  pool->in_use--;
+  int32_t index = moonbit_uv_buffer_pool_class(Moonbit_array_length(bytes));
+  moonbit_uv_buffer_pool_class_t *size_class = &pool->classes[index];
+  if (Moonbit_object_header(bytes)->rc == 1) {
+    if (size_class->count < MOONBIT_UV_BUFFER_POOL_CAPACITY) {
+      size_class->free[size_class->count++] = bytes;
+      return;
+    }
+  } else {
+    pool->retained++;
+  }
+  moonbit_decref(bytes);
+}
+
+static inline void
+moonbit_uv_buffer_pool_destroy(moonbit_uv_buffer_pool_t *pool) {
+  for (int32_t i = 0; i < MOONBIT_UV_BUFFER_POOL_CLASSES; i++) {
+    moonbit_uv_buffer_pool_class_t *size_class = &pool->classes[i];
+    while (size_class->count > 0) {
+      moonbit_decref(size_class->free[--size_class->count]);
+    }
+  }
+}
+
+#endif // MOONBIT_UV_BUFFER_POOL_H
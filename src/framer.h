@@ -0,0 +1,240 @@
+/*
+ * Copyright 2026 International Digital Economy Academy
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MOONBIT_UV_FRAMER_H
+#define MOONBIT_UV_FRAMER_H
+
+#include "uv#include#uv.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum moonbit_uv_framing_e {
+  MOONBIT_UV_FRAMING_U16_BE = 0,
+  MOONBIT_UV_FRAMING_U16_LE = 1,
+  MOONBIT_UV_FRAMING_U32_BE = 2,
+  MOONBIT_UV_FRAMING_U32_LE = 3,
+  MOONBIT_UV_FRAMING_DELIMITER = 4,
+  MOONBIT_UV_FRAMING_LINE = 5,
+} moonbit_uv_framing_t;
+
+// Minimum free space offered to libuv for each read.
+#define MOONBIT_UV_FRAMER_READ_SIZE 65536
+
+// Accumulates the bytes read from a stream in a native buffer and splits them
+// into frames. Bytes in `[start, end)` of `data` are received but not framed
+// yet.
+typedef struct moonbit_uv_framer_s {
+  moonbit_uv_framing_t framing;
+  uint8_t delimiter;
+  size_t max_frame_length;
+  char *data;
+  size_t start;
+  size_t end;
+  size_t capacity;
+  // Number of bytes after `start` already searched for the delimiter.
+  size_t scanned;
+  // Offsets and lengths of the frames found by the last read.
+  size_t *frames;
+  size_t frames_capacity;
+} moonbit_uv_framer_t;
+
+static inline moonbit_uv_framer_t *
+moonbit_uv_framer_make(
+  moonbit_uv_framing_t framing,
+  uint8_t delimiter,
+  size_t max_frame_length
+) {
+  moonbit_uv_framer_t *framer = calloc(1, sizeof(moonbit_uv_framer_t));
+  if (framer) {
+    framer->framing = framing;
+    framer->delimiter = delimiter;
+    framer->max_frame_length = max_frame_length;
+  }
+  return framer;
+}
+
+static inline void
+moonbit_uv_framer_free(moonbit_uv_framer_t *framer) {
+  free(framer->data);
+  free(framer->frames);
+  free(framer);
+}
+
+// Provides the free space at the end of the buffer to read into. An empty
+// buffer is returned on allocation failure, which libuv reports as
+// `UV_ENOBUFS`.
+static inline void
+moonbit_uv_framer_reserve(moonbit_uv_framer_t *framer, uv_buf_t *buf) {
+  if (framer->capacity - framer->end < MOONBIT_UV_FRAMER_READ_SIZE &&
+      framer->start > 0) {
+    memmove(
+      framer->data, framer->data + framer->start, framer->end - framer->start
+    );
+    framer->end -= framer->start;
+    framer->start = 0;
+  }
+  if (framer->capacity - framer->end < MOONBIT_UV_FRAMER_READ_SIZE) {
+    size_t capacity =
+      framer->capacity ? framer->capacity : MOONBIT_UV_FRAMER_READ_SIZE;
+    while (capacity - framer->end < MOONBIT_UV_FRAMER_READ_SIZE) {
+      capacity *= 2;
+    }
+    char *data = realloc(framer->data, capacity);
+    if (data == NULL) {
+      *buf = uv_buf_init(NULL, 0);
+      return;
+    }
+    framer->data = data;
+    framer->capacity = capacity;
+  }
+  *buf = uv_buf_init(
+    framer->data + framer->end, framer->capacity - framer->end
+  );
+}
+
+// Releases the buffer once every received byte has been framed, so that an
+// idle stream does not keep a large buffer around.
+static inline void
+moonbit_uv_framer_compact(moonbit_uv_framer_t *framer) {
+  if (framer->start != framer->end) {
+    return;
+  }
+  framer->start = 0;
+  framer->end = 0;
+  if (framer->capacity > 4 * MOONBIT_UV_FRAMER_READ_SIZE) {
+    free(framer->data);
+    framer->data = NULL;
+    framer->capacity = 0;
+  }
+}
+
+// Finds the next complete frame. Returns 1 and sets `offset` and `length` to
+// the payload of the frame if there is one, 0 if more data is needed, or
+// `UV_EMSGSIZE` if the frame exceeds `max_frame_length`.
+static inline int
+moonbit_uv_framer_next(
+  moonbit_uv_framer_t *framer,
+  size_t *offset,
+  size_t *length
+) {
+  const uint8_t *p = (const uint8_t *)framer->data + framer->start;
+  size_t available = framer->end - framer->start;
+  size_t prefix = 0;
+  size_t frame = 0;
+  switch (framer->framing) {
+  case MOONBIT_UV_FRAMING_U16_BE:
+  case MOONBIT_UV_FRAMING_U16_LE:
+    prefix = 2;
+    if (available < prefix) {
+      return 0;
+    }
+    frame = framer->framing == MOONBIT_UV_FRAMING_U16_BE
+              ? (size_t)p[0] << 8 | p[1]
+              : (size_t)p[1] << 8 | p[0];
+    break;
+  case MOONBIT_UV_FRAMING_U32_BE:
+  case MOONBIT_UV_FRAMING_U32_LE:
+    prefix = 4;
+    if (available < prefix) {
+      return 0;
+    }
+    frame = framer->framing == MOONBIT_UV_FRAMING_U32_BE
+              ? (size_t)p[0] << 24 | (size_t)p[1] << 16 | (size_t)p[2] << 8 |
+                  p[3]
+              : (size_t)p[3] << 24 | (size_t)p[2] << 16 | (size_t)p[1] << 8 |
+                  p[0];
+    break;
+  case MOONBIT_UV_FRAMING_DELIMITER:
+  case MOONBIT_UV_FRAMING_LINE: {
+    uint8_t delimiter = framer->framing == MOONBIT_UV_FRAMING_LINE
+                          ? '\n'
+                          : framer->delimiter;
+    // `memchr()` from libc is vectorized on the platforms we care about.
+    const uint8_t *found = memchr(
+      p + framer->scanned, delimiter, available - framer->scanned
+    );
+    if (found == NULL) {
+      framer->scanned = available;
+      return available > framer->max_frame_length ? UV_EMSGSIZE : 0;
+    }
+    frame = found - p;
+    if (frame > framer->max_frame_length) {
+      return UV_EMSGSIZE;
+    }
+    *offset = framer->start;
+    *length = frame;
+    if (framer->framing == MOONBIT_UV_FRAMING_LINE && frame > 0 &&
+        p[frame - 1] == '\r') {
+      *length = frame - 1;
+    }
+    framer->start += frame + 1;
+    framer->scanned = 0;
+    return 1;
+  }
+  }
+  if (frame > framer->max_frame_length) {
+    return UV_EMSGSIZE;
+  }
+  if (available - prefix < frame) {
+    return 0;
+  }
+  *offset = framer->start + prefix;
+  *length = frame;
+  framer->start += prefix + frame;
+  return 1;
+}
+
+// Collects all complete frames into `framer->frames`. Returns the number of
+// frames found, and stores `UV_EMSGSIZE` or `UV_ENOMEM` in `status` if framing
+// had to stop early.
+static inline size_t
+moonbit_uv_framer_collect(
+  moonbit_uv_framer_t *framer,
+  size_t *total,
+  int32_t *status
+) {
+  size_t count = 0;
+  *total = 0;
+  *status = 0;
+  for (;;) {
+    if (count == framer->frames_capacity) {
+      size_t capacity = count ? count * 2 : 16;
+      size_t *frames = realloc(framer->frames, sizeof(size_t) * 2 * capacity);
+      if (frames == NULL) {
+        *status = UV_ENOMEM;
+        break;
+      }
+      framer->frames = frames;
+      framer->frames_capacity = capacity;
+    }
+    size_t offset = 0;
+    size_t length = 0;
+    int result = moonbit_uv_framer_next(framer, &offset, &length);
+    if (result <= 0) {
+      *status = result;
+      break;
+    }
+    framer->frames[2 * count] = offset;
+    framer->frames[2 * count + 1] = length;
+    *total += length;
+    count++;
+  }
+  return count;
+}
+
+#endif // MOONBIT_UV_FRAMER_H
@@ -23,6 +23,16 @@
 #else
 #include <unistd.h>
 #endif
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#endif
+#if __STDC_VERSION__ >= 201112L
+#include <stdatomic.h>
+#endif
+#include "loop.h"
 #include "uv.h"
 
 typedef struct moonbit_uv_fs_s {
@@ -82,11 +92,59 @@ moonbit_uv_fs_make(void) {
   return fs;
 }
 
+MOONBIT_FFI_EXPORT
+moonbit_uv_fs_t *
+moonbit_uv_fs_acquire(uv_loop_t *loop) {
+  moonbit_uv_loop_data_t *data = moonbit_uv_loop_data(loop);
+  moonbit_uv_fs_t *fs =
+    data ? moonbit_uv_req_pool_acquire(&data->fs_pool) : NULL;
+  return fs ? fs : moonbit_uv_fs_make();
+}
+
+// Resets `fs` and gives it back to the pool of its loop, if nothing but the
+// caller references it any longer. Returns whether it was recycled.
+static inline bool
+moonbit_uv_fs_recycle(moonbit_uv_fs_t *fs) {
+  uv_loop_t *loop = fs->fs.loop;
+  // The request holds a reference to its loop, which it drops when recycled:
+  // it must not be the last one.
+  if (loop == NULL || loop->data == NULL || fs->fs.data ||
+      Moonbit_object_header(loop)->rc <= 1) {
+    return false;
+  }
+  moonbit_uv_req_pool_t *pool = &((moonbit_uv_loop_data_t *)loop->data)->fs_pool;
+  if (!moonbit_uv_req_pool_recyclable(pool, fs)) {
+    return false;
+  }
+  if (fs->bufs_base) {
+    moonbit_decref(fs->bufs_base);
+  }
+  memset(fs, 0, sizeof(moonbit_uv_fs_t));
+  moonbit_decref(loop);
+  moonbit_uv_req_pool_release(pool, fs);
+  return true;
+}
+
+// Drops the reference of a synchronous call to `fs`. If the caller does not use
+// it afterwards, its results are released and it is recycled right away.
+static inline void
+moonbit_uv_fs_release(moonbit_uv_fs_t *fs) {
+  if (Moonbit_object_header(fs)->rc == 1) {
+    uv_fs_req_cleanup(&fs->fs);
+    if (moonbit_uv_fs_recycle(fs)) {
+      return;
+    }
+  }
+  moonbit_decref(fs);
+}
+
 MOONBIT_FFI_EXPORT
 void
 moonbit_uv_fs_req_cleanup(moonbit_uv_fs_t *fs) {
   uv_fs_req_cleanup(&fs->fs);
-  moonbit_decref(fs);
+  if (!moonbit_uv_fs_recycle(fs)) {
+    moonbit_decref(fs);
+  }
 }
 
 MOONBIT_FFI_EXPORT
@@ -274,7 +332,7 @@ moonbit_uv_fs_open_sync(
   moonbit_uv_tracef("loop->rc = %d\n", Moonbit_object_header(loop)->rc);
   moonbit_uv_fs_set_data(fs, NULL);
   int result = uv_fs_open(loop, &fs->fs, (const char *)path, flags, mode, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return result;
 }
@@ -307,7 +365,7 @@ moonbit_uv_fs_close_sync(uv_loop_t *loop, moonbit_uv_fs_t *fs, int32_t file) {
   moonbit_uv_tracef("fs->rc = %d\n", Moonbit_object_header(fs)->rc);
   moonbit_uv_fs_set_data(fs, NULL);
   int result = uv_fs_close(loop, &fs->fs, file, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   return result;
 }
 
@@ -373,7 +431,7 @@ moonbit_uv_fs_read_sync(
   int result =
     uv_fs_read(loop, &fs->fs, file, bufs_data, bufs_size, offset, NULL);
   free(bufs_data);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(bufs_base);
   moonbit_decref(bufs_offset);
   moonbit_decref(bufs_length);
@@ -431,7 +489,7 @@ moonbit_uv_fs_write_sync(
   moonbit_uv_fs_set_bufs(fs, bufs_base);
   int result = uv_fs_write(loop, &fs->fs, file, bufs, bufs_size, offset, NULL);
   free(bufs);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(bufs_offset);
   moonbit_decref(bufs_length);
   return result;
@@ -469,7 +527,7 @@ int32_t
 moonbit_uv_fs_fsync_sync(uv_loop_t *loop, moonbit_uv_fs_t *fs, int32_t file) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_fsync(loop, &fs->fs, file, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   return status;
 }
 
@@ -495,7 +553,7 @@ moonbit_uv_fs_fdatasync_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_fdatasync(loop, &fs->fs, file, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   return status;
 }
 
@@ -525,7 +583,7 @@ moonbit_uv_fs_mkdir_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_mkdir(loop, &fs->fs, (const char *)path, mode, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -553,7 +611,7 @@ moonbit_uv_fs_rmdir_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_rmdir(loop, &fs->fs, (const char *)path, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -609,7 +667,7 @@ moonbit_uv_fs_copyfile_sync(
   int status = uv_fs_copyfile(
     loop, &fs->fs, (const char *)path, (const char *)new_path, flags, NULL
   );
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   moonbit_decref(new_path);
   return status;
@@ -639,7 +697,7 @@ moonbit_uv_fs_unlink_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_unlink(loop, &fs->fs, (const char *)path, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -710,7 +768,7 @@ moonbit_uv_fs_scandir_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_scandir(loop, &fs->fs, (const char *)path, flags, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -848,7 +906,7 @@ moonbit_uv_fs_stat_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_stat(loop, &fs->fs, (const char *)path, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -876,7 +934,7 @@ moonbit_uv_fs_lstat_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_lstat(loop, &fs->fs, (const char *)path, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -918,7 +976,7 @@ moonbit_uv_fs_realpath_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_realpath(loop, &fs->fs, (const char *)path, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -973,7 +1031,7 @@ moonbit_uv_fs_access_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_access(loop, &fs->fs, (const char *)path, mode, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -1015,7 +1073,7 @@ moonbit_uv_fs_mkdtemp_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_mkdtemp(loop, &fs->fs, (const char *)template_path, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(template_path);
   return status;
 }
@@ -1044,7 +1102,7 @@ moonbit_uv_fs_mkstemp_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_mkstemp(loop, &fs->fs, (const char *)template_path, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(template_path);
   return status;
 }
@@ -1098,7 +1156,7 @@ moonbit_uv_fs_opendir_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_opendir(loop, &fs->fs, (const char *)path, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -1125,7 +1183,7 @@ moonbit_uv_fs_closedir_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_closedir(loop, &fs->fs, dir, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   return status;
 }
 
@@ -1158,7 +1216,7 @@ moonbit_uv_fs_readdir_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_readdir(loop, &fs->fs, dir, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   return status;
 }
 
@@ -1191,7 +1249,7 @@ moonbit_uv_fs_link_sync(
   moonbit_uv_fs_set_data(fs, NULL);
   int status =
     uv_fs_link(loop, &fs->fs, (const char *)path, (const char *)new_path, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   moonbit_decref(new_path);
   return status;
@@ -1242,7 +1300,7 @@ moonbit_uv_fs_symlink_sync(
   int status = uv_fs_symlink(
     loop, &fs->fs, (const char *)path, (const char *)new_path, flags, NULL
   );
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   moonbit_decref(new_path);
   return status;
@@ -1272,7 +1330,7 @@ moonbit_uv_fs_readlink_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_readlink(loop, &fs->fs, (const char *)path, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -1309,7 +1367,7 @@ moonbit_uv_fs_chown_sync(
   int status = uv_fs_chown(
     loop, &fs->fs, (const char *)path, (uv_uid_t)uid, (uv_gid_t)gid, NULL
   );
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -1343,7 +1401,7 @@ moonbit_uv_fs_fchown_sync(
   moonbit_uv_fs_set_data(fs, NULL);
   int status =
     uv_fs_fchown(loop, &fs->fs, file, (uv_uid_t)uid, (uv_gid_t)gid, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   return status;
 }
 
@@ -1379,7 +1437,7 @@ moonbit_uv_fs_lchown_sync(
   int status = uv_fs_lchown(
     loop, &fs->fs, (const char *)path, (uv_uid_t)uid, (uv_gid_t)gid, NULL
   );
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -1415,7 +1473,7 @@ moonbit_uv_fs_sendfile_sync(
   moonbit_uv_fs_set_data(fs, NULL);
   int status =
     uv_fs_sendfile(loop, &fs->fs, out_fd, in_fd, in_offset, length, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   return status;
 }
 
@@ -1445,7 +1503,7 @@ moonbit_uv_fs_chmod_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_chmod(loop, &fs->fs, (const char *)path, mode, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -1474,7 +1532,7 @@ moonbit_uv_fs_fchmod_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_fchmod(loop, &fs->fs, file, mode, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   return status;
 }
 
@@ -1502,7 +1560,7 @@ moonbit_uv_fs_statfs_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_statfs(loop, &fs->fs, (const char *)path, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -1583,7 +1641,7 @@ moonbit_uv_fs_utime_sync(
   moonbit_uv_fs_set_data(fs, NULL);
   int status =
     uv_fs_utime(loop, &fs->fs, (const char *)path, atime, mtime, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
@@ -1615,7 +1673,7 @@ moonbit_uv_fs_futime_sync(
 ) {
   moonbit_uv_fs_set_data(fs, NULL);
   int status = uv_fs_futime(loop, &fs->fs, file, atime, mtime, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   return status;
 }
 
@@ -1649,7 +1707,542 @@ moonbit_uv_fs_lutime_sync(
   moonbit_uv_fs_set_data(fs, NULL);
   int status =
     uv_fs_lutime(loop, &fs->fs, (const char *)path, atime, mtime, NULL);
-  moonbit_decref(fs);
+  moonbit_uv_fs_release(fs);
   moonbit_decref(path);
   return status;
 }
+
+typedef struct moonbit_uv_fs_file_cb_s {
+  int32_t (*code)(
+    struct moonbit_uv_fs_file_cb_s *,
+    int32_t status,
+    moonbit_bytes_t data
+  );
+} moonbit_uv_fs_file_cb_t;
+
+// A whole-file read or write, run as a single threadpool job with
+// synchronous `uv_fs_*` calls instead of a job per step.
+typedef struct moonbit_uv_fs_file_s {
+  uv_work_t work;
+  uv_loop_t *loop;
+  moonbit_uv_fs_file_cb_t *cb;
+  moonbit_bytes_t path;
+  // Data read, allocated with `malloc()` by the job.
+  char *data;
+  size_t length;
+  // Data to write, borrowed from `bytes`.
+  moonbit_bytes_t bytes;
+  int32_t offset;
+  int32_t mode;
+  bool atomic;
+  int32_t status;
+} moonbit_uv_fs_file_t;
+
+static inline void
+moonbit_uv_fs_file_close(uv_file file) {
+  uv_fs_t req;
+  uv_fs_close(NULL, &req, file, NULL);
+  uv_fs_req_cleanup(&req);
+}
+
+static inline int32_t
+moonbit_uv_fs_file_read_all(moonbit_uv_fs_file_t *job, uv_file file) {
+  uv_fs_t req;
+  int32_t status = uv_fs_fstat(NULL, &req, file, NULL);
+  // Files such as those of /proc report a size of 0, or may grow while being
+  // read: the buffer grows until the end of the file is reached.
+  size_t capacity = status < 0 ? 0 : req.statbuf.st_size;
+  uv_fs_req_cleanup(&req);
+  // The contents are handed to MoonBit as a single `Bytes`, whose length is
+  // an `Int`.
+  if (capacity > INT32_MAX) {
+    return UV_EFBIG;
+  }
+  capacity = capacity < 4096 ? 4096 : capacity + 1;
+  for (;;) {
+    if (job->data == NULL || job->length == capacity) {
+      if (job->data != NULL) {
+        capacity *= 2;
+        if (capacity > (size_t)INT32_MAX + 1) {
+          capacity = (size_t)INT32_MAX + 1;
+        }
+      }
+      char *data = realloc(job->data, capacity);
+      if (data == NULL) {
+        return UV_ENOMEM;
+      }
+      job->data = data;
+    }
+    uv_buf_t buf =
+      uv_buf_init(job->data + job->length, capacity - job->length);
+    status = uv_fs_read(NULL, &req, file, &buf, 1, -1, NULL);
+    uv_fs_req_cleanup(&req);
+    if (status <= 0) {
+      return status;
+    }
+    job->length += status;
+    if (job->length > INT32_MAX) {
+      return UV_EFBIG;
+    }
+  }
+}
+
+static inline void
+moonbit_uv_fs_read_file_work_cb(uv_work_t *work) {
+  moonbit_uv_fs_file_t *job = (moonbit_uv_fs_file_t *)work;
+  uv_fs_t req;
+  int32_t file =
+    uv_fs_open(NULL, &req, (const char *)job->path, UV_FS_O_RDONLY, 0, NULL);
+  uv_fs_req_cleanup(&req);
+  if (file < 0) {
+    job->status = file;
+    return;
+  }
+  job->status = moonbit_uv_fs_file_read_all(job, file);
+  moonbit_uv_fs_file_close(file);
+}
+
+static inline int32_t
+moonbit_uv_fs_file_write_all(moonbit_uv_fs_file_t *job, uv_file file) {
+  uv_fs_t req;
+  size_t written = 0;
+  while (written < job->length) {
+    uv_buf_t buf = uv_buf_init(
+      (char *)job->bytes + job->offset + written, job->length - written
+    );
+    int32_t status = uv_fs_write(NULL, &req, file, &buf, 1, -1, NULL);
+    uv_fs_req_cleanup(&req);
+    if (status < 0) {
+      return status;
+    }
+    written += status;
+  }
+  return 0;
+}
+
+static inline void
+moonbit_uv_fs_write_file_work_cb(uv_work_t *work) {
+  moonbit_uv_fs_file_t *job = (moonbit_uv_fs_file_t *)work;
+  uv_fs_t req;
+  if (!job->atomic) {
+    int32_t file = uv_fs_open(
+      NULL, &req, (const char *)job->path,
+      UV_FS_O_WRONLY | UV_FS_O_CREAT | UV_FS_O_TRUNC, job->mode, NULL
+    );
+    uv_fs_req_cleanup(&req);
+    if (file < 0) {
+      job->status = file;
+      return;
+    }
+    job->status = moonbit_uv_fs_file_write_all(job, file);
+    moonbit_uv_fs_file_close(file);
+    return;
+  }
+  // Write to a temporary file next to the destination, so that the rename
+  // stays within one file system and replaces the destination atomically.
+  size_t path_length = strlen((const char *)job->path);
+  char *template = malloc(path_length + sizeof(".XXXXXX"));
+  if (template == NULL) {
+    job->status = UV_ENOMEM;
+    return;
+  }
+  memcpy(template, job->path, path_length);
+  memcpy(template + path_length, ".XXXXXX", sizeof(".XXXXXX"));
+  int32_t file = uv_fs_mkstemp(NULL, &req, template, NULL);
+  char *temporary = NULL;
+  if (file >= 0) {
+    temporary = strdup(req.path);
+  }
+  uv_fs_req_cleanup(&req);
+  free(template);
+  if (file < 0) {
+    job->status = file;
+    return;
+  }
+  if (temporary == NULL) {
+    moonbit_uv_fs_file_close(file);
+    job->status = UV_ENOMEM;
+    return;
+  }
+  int32_t status = uv_fs_fchmod(NULL, &req, file, job->mode, NULL);
+  uv_fs_req_cleanup(&req);
+  if (status == 0) {
+    status = moonbit_uv_fs_file_write_all(job, file);
+  }
+  if (status == 0) {
+    status = uv_fs_fsync(NULL, &req, file, NULL);
+    uv_fs_req_cleanup(&req);
+  }
+  moonbit_uv_fs_file_close(file);
+  if (status == 0) {
+    status = uv_fs_rename(
+      NULL, &req, temporary, (const char *)job->path, NULL
+    );
+    uv_fs_req_cleanup(&req);
+  }
+  if (status < 0) {
+    uv_fs_unlink(NULL, &req, temporary, NULL);
+    uv_fs_req_cleanup(&req);
+  }
+  free(temporary);
+  job->status = status;
+}
+
+static inline void
+moonbit_uv_fs_file_after_work_cb(uv_work_t *work, int status) {
+  moonbit_uv_fs_file_t *job = (moonbit_uv_fs_file_t *)work;
+  if (status == 0) {
+    status = job->status;
+  }
+  moonbit_bytes_t data;
+  if (status < 0 || job->data == NULL) {
+    data = moonbit_make_bytes(0, 0);
+  } else {
+    data = moonbit_make_bytes(job->length, 0);
+    memcpy(data, job->data, job->length);
+  }
+  moonbit_uv_fs_file_cb_t *cb = job->cb;
+  free(job->data);
+  moonbit_decref(job->path);
+  if (job->bytes) {
+    moonbit_decref(job->bytes);
+  }
+  moonbit_decref(job->loop);
+  free(job);
+  cb->code(cb, status, data);
+}
+
+static inline int32_t
+moonbit_uv_fs_file_queue(
+  moonbit_uv_fs_file_t *job,
+  uv_work_cb work_cb
+) {
+  int32_t status = uv_queue_work(
+    job->loop, &job->work, work_cb, moonbit_uv_fs_file_after_work_cb
+  );
+  if (status < 0) {
+    moonbit_decref(job->cb);
+    moonbit_decref(job->path);
+    if (job->bytes) {
+      moonbit_decref(job->bytes);
+    }
+    moonbit_decref(job->loop);
+    free(job);
+  }
+  return status;
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_fs_read_file(
+  uv_loop_t *loop,
+  moonbit_bytes_t path,
+  moonbit_uv_fs_file_cb_t *cb
+) {
+  moonbit_uv_fs_file_t *job = malloc(sizeof(moonbit_uv_fs_file_t));
+  if (job == NULL) {
+    moonbit_decref(cb);
+    moonbit_decref(path);
+    moonbit_decref(loop);
+    return UV_ENOMEM;
+  }
+  memset(job, 0, sizeof(moonbit_uv_fs_file_t));
+  job->loop = loop;
+  job->cb = cb;
+  job->path = path;
+  return moonbit_uv_fs_file_queue(job, moonbit_uv_fs_read_file_work_cb);
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_fs_write_file(
+  uv_loop_t *loop,
+  moonbit_bytes_t path,
+  moonbit_bytes_t bytes,
+  int32_t offset,
+  int32_t length,
+  int32_t mode,
+  bool atomic,
+  moonbit_uv_fs_file_cb_t *cb
+) {
+  moonbit_uv_fs_file_t *job = malloc(sizeof(moonbit_uv_fs_file_t));
+  if (job == NULL) {
+    moonbit_decref(cb);
+    moonbit_decref(bytes);
+    moonbit_decref(path);
+    moonbit_decref(loop);
+    return UV_ENOMEM;
+  }
+  memset(job, 0, sizeof(moonbit_uv_fs_file_t));
+  job->loop = loop;
+  job->cb = cb;
+  job->path = path;
+  job->bytes = bytes;
+  job->offset = offset;
+  job->length = length;
+  job->mode = mode;
+  job->atomic = atomic;
+  return moonbit_uv_fs_file_queue(job, moonbit_uv_fs_write_file_work_cb);
+}
+
+#if defined(__linux__) && defined(__NR_statx)
+// The layout of `struct statx` is part of the kernel ABI; it is declared here
+// to avoid depending on the C library or kernel headers providing it.
+typedef struct moonbit_uv_statx_timestamp_s {
+  int64_t tv_sec;
+  uint32_t tv_nsec;
+  int32_t reserved;
+} moonbit_uv_statx_timestamp_t;
+
+typedef struct moonbit_uv_statx_s {
+  uint32_t stx_mask;
+  uint32_t stx_blksize;
+  uint64_t stx_attributes;
+  uint32_t stx_nlink;
+  uint32_t stx_uid;
+  uint32_t stx_gid;
+  uint16_t stx_mode;
+  uint16_t unused0;
+  uint64_t stx_ino;
+  uint64_t stx_size;
+  uint64_t stx_blocks;
+  uint64_t stx_attributes_mask;
+  moonbit_uv_statx_timestamp_t stx_atime;
+  moonbit_uv_statx_timestamp_t stx_btime;
+  moonbit_uv_statx_timestamp_t stx_ctime;
+  moonbit_uv_statx_timestamp_t stx_mtime;
+  uint32_t stx_rdev_major;
+  uint32_t stx_rdev_minor;
+  uint32_t stx_dev_major;
+  uint32_t stx_dev_minor;
+  uint64_t unused1[14];
+} moonbit_uv_statx_t;
+
+// Set once `statx()` turns out to be unavailable (old kernel or seccomp), by
+// any of the threadpool threads. Jobs racing on it at worst try `statx()` once
+// more each.
+#if __STDC_VERSION__ >= 201112L
+static _Atomic bool moonbit_uv_statx_unavailable = false;
+#else
+static bool moonbit_uv_statx_unavailable = false;
+#endif
+
+static inline bool
+moonbit_uv_statx_is_unavailable(void) {
+#if __STDC_VERSION__ >= 201112L
+  return atomic_load_explicit(
+    &moonbit_uv_statx_unavailable, memory_order_relaxed
+  );
+#else
+  return __atomic_load_n(&moonbit_uv_statx_unavailable, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline void
+moonbit_uv_statx_set_unavailable(void) {
+#if __STDC_VERSION__ >= 201112L
+  atomic_store_explicit(
+    &moonbit_uv_statx_unavailable, true, memory_order_relaxed
+  );
+#else
+  __atomic_store_n(&moonbit_uv_statx_unavailable, true, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline int32_t
+moonbit_uv_fs_statx(
+  const char *path,
+  uint32_t mask,
+  bool follow,
+  uv_stat_t *statbuf
+) {
+  moonbit_uv_statx_t stx;
+  int flags = follow ? 0 : AT_SYMLINK_NOFOLLOW;
+  if (syscall(__NR_statx, AT_FDCWD, path, flags, mask, &stx) < 0) {
+    return uv_translate_sys_error(errno);
+  }
+  // Same encoding as `stat()` and libuv's own use of `statx()`.
+  statbuf->st_dev = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+  statbuf->st_mode = stx.stx_mode;
+  statbuf->st_nlink = stx.stx_nlink;
+  statbuf->st_uid = stx.stx_uid;
+  statbuf->st_gid = stx.stx_gid;
+  statbuf->st_rdev = makedev(stx.stx_rdev_major, stx.stx_rdev_minor);
+  statbuf->st_ino = stx.stx_ino;
+  statbuf->st_size = stx.stx_size;
+  statbuf->st_blksize = stx.stx_blksize;
+  statbuf->st_blocks = stx.stx_blocks;
+  statbuf->st_atim.tv_sec = stx.stx_atime.tv_sec;
+  statbuf->st_atim.tv_nsec = stx.stx_atime.tv_nsec;
+  statbuf->st_mtim.tv_sec = stx.stx_mtime.tv_sec;
+  statbuf->st_mtim.tv_nsec = stx.stx_mtime.tv_nsec;
+  statbuf->st_ctim.tv_sec = stx.stx_ctime.tv_sec;
+  statbuf->st_ctim.tv_nsec = stx.stx_ctime.tv_nsec;
+  statbuf->st_birthtim.tv_sec = stx.stx_btime.tv_sec;
+  statbuf->st_birthtim.tv_nsec = stx.stx_btime.tv_nsec;
+  return 0;
+}
+#endif
+
+typedef struct moonbit_uv_fs_stat_many_cb_s {
+  int32_t (*code)(
+    struct moonbit_uv_fs_stat_many_cb_s *,
+    int32_t status,
+    moonbit_bytes_t stats,
+    int32_t *errors
+  );
+} moonbit_uv_fs_stat_many_cb_t;
+
+typedef struct moonbit_uv_fs_stat_chunk_s moonbit_uv_fs_stat_chunk_t;
+
+typedef struct moonbit_uv_fs_stat_many_s {
+  uv_loop_t *loop;
+  moonbit_uv_fs_stat_many_cb_t *cb;
+  moonbit_bytes_t *paths;
+  int32_t count;
+  // `count` packed `uv_stat_t`, filled in by the jobs.
+  moonbit_bytes_t stats;
+  int32_t *errors;
+  // A mask of `STATX_*` fields, or 0 for a full `stat()`.
+  uint32_t mask;
+  bool follow;
+  moonbit_uv_fs_stat_chunk_t *chunks;
+  int32_t pending;
+  int32_t status;
+} moonbit_uv_fs_stat_many_t;
+
+struct moonbit_uv_fs_stat_chunk_s {
+  uv_work_t work;
+  moonbit_uv_fs_stat_many_t *batch;
+  int32_t start;
+  int32_t end;
+};
+
+static inline void
+moonbit_uv_fs_stat_chunk_work_cb(uv_work_t *work) {
+  moonbit_uv_fs_stat_chunk_t *chunk = (moonbit_uv_fs_stat_chunk_t *)work;
+  moonbit_uv_fs_stat_many_t *batch = chunk->batch;
+  uv_stat_t *stats = (uv_stat_t *)batch->stats;
+  for (int32_t i = chunk->start; i < chunk->end; i++) {
+    const char *path = (const char *)batch->paths[i];
+#if defined(__linux__) && defined(__NR_statx)
+    if (batch->mask != 0 && !moonbit_uv_statx_is_unavailable()) {
+      int32_t status =
+        moonbit_uv_fs_statx(path, batch->mask, batch->follow, &stats[i]);
+      if (status != UV_ENOSYS && status != UV_EPERM) {
+        batch->errors[i] = status;
+        continue;
+      }
+      moonbit_uv_statx_set_unavailable();
+    }
+#endif
+    uv_fs_t req;
+    int32_t status = batch->follow ? uv_fs_stat(NULL, &req, path, NULL)
+                                   : uv_fs_lstat(NULL, &req, path, NULL);
+    if (status == 0) {
+      memcpy(&stats[i], &req.statbuf, sizeof(uv_stat_t));
+    }
+    uv_fs_req_cleanup(&req);
+    batch->errors[i] = status;
+  }
+}
+
+static inline void
+moonbit_uv_fs_stat_chunk_after_work_cb(uv_work_t *work, int status) {
+  moonbit_uv_fs_stat_chunk_t *chunk = (moonbit_uv_fs_stat_chunk_t *)work;
+  moonbit_uv_fs_stat_many_t *batch = chunk->batch;
+  if (status < 0) {
+    batch->status = status;
+  }
+  if (--batch->pending > 0) {
+    return;
+  }
+  free(batch->chunks);
+  moonbit_uv_fs_stat_many_cb_t *cb = batch->cb;
+  moonbit_bytes_t stats = batch->stats;
+  int32_t *errors = batch->errors;
+  status = batch->status;
+  moonbit_decref(batch->paths);
+  moonbit_decref(batch->loop);
+  free(batch);
+  cb->code(cb, status, stats, errors);
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_fs_stat_many(
+  uv_loop_t *loop,
+  moonbit_bytes_t *paths,
+  uint32_t mask,
+  bool follow,
+  int32_t chunk_size,
+  moonbit_uv_fs_stat_many_cb_t *cb
+) {
+  int32_t count = Moonbit_array_length(paths);
+  if (chunk_size <= 0) {
+    chunk_size = 1;
+  }
+  // An empty batch still goes through one (empty) job, so that the callback
+  // is never invoked synchronously.
+  int32_t chunks_count = count == 0 ? 1 : (count - 1) / chunk_size + 1;
+  moonbit_uv_fs_stat_many_t *batch = malloc(sizeof(moonbit_uv_fs_stat_many_t));
+  moonbit_uv_fs_stat_chunk_t *chunks =
+    malloc(sizeof(moonbit_uv_fs_stat_chunk_t) * chunks_count);
+  if (batch == NULL || chunks == NULL) {
+    free(batch);
+    free(chunks);
+    moonbit_decref(cb);
+    moonbit_decref(paths);
+    moonbit_decref(loop);
+    return UV_ENOMEM;
+  }
+  batch->loop = loop;
+  batch->cb = cb;
+  batch->paths = paths;
+  batch->count = count;
+  batch->stats = moonbit_make_bytes(sizeof(uv_stat_t) * count, 0);
+  batch->errors = moonbit_make_int32_array(count, 0);
+  batch->mask = mask;
+  batch->follow = follow;
+  batch->chunks = chunks;
+  batch->pending = 0;
+  batch->status = 0;
+  for (int32_t i = 0; i < chunks_count; i++) {
+    moonbit_uv_fs_stat_chunk_t *chunk = &chunks[i];
+    chunk->batch = batch;
+    chunk->start = i * chunk_size;
+    chunk->end = chunk->start + chunk_size < count ? chunk->start + chunk_size
+                                                   : count;
+    int32_t status = uv_queue_work(
+      loop, &chunk->work, moonbit_uv_fs_stat_chunk_work_cb,
+      moonbit_uv_fs_stat_chunk_after_work_cb
+    );
+    if (status < 0) {
+      if (batch->pending == 0) {
+        moonbit_decref(batch->errors);
+        moonbit_decref(batch->stats);
+        free(chunks);
+        free(batch);
+        moonbit_decref(cb);
+        moonbit_decref(paths);
+        moonbit_decref(loop);
+        return status;
+      }
+      // Report the paths of the chunks that could not be queued.
+      for (int32_t j = chunk->start; j < count; j++) {
+        batch->errors[j] = status;
+      }
+      break;
+    }
+    batch->pending++;
+  }
+  return 0;
+}
+
+MOONBIT_FFI_EXPORT
+moonbit_bytes_t
+moonbit_uv_fs_stat_many_get(moonbit_bytes_t stats, int32_t index) {
+  moonbit_bytes_t stat = moonbit_make_bytes(sizeof(uv_stat_t), 0);
+  memcpy(stat, (uv_stat_t *)stats + index, sizeof(uv_stat_t));
+  return stat;
+}
@@ -0,0 +1,614 @@
+/*
+ * Copyright 2026 International Digital Economy Academy
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include "moonbit.h"
+#include "uv#include#uv.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uv.h"
+
+// Each entry of a batch is described by these many integers: the offset and
+// length of its path in the names buffer, its type, its depth and its status.
+#define MOONBIT_UV_FS_WALK_RECORD 5
+
+typedef struct moonbit_uv_fs_walk_cb_s {
+  int32_t (*code)(
+    struct moonbit_uv_fs_walk_cb_s *,
+    int32_t status,
+    moonbit_bytes_t names,
+    int32_t *records,
+    moonbit_bytes_t stats,
+    bool done
+  );
+} moonbit_uv_fs_walk_cb_t;
+
+#ifndef _WIN32
+#ifdef __linux__
+// The layout of the records returned by `getdents64()`.
+typedef struct moonbit_uv_linux_dirent64_s {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[];
+} moonbit_uv_linux_dirent64_t;
+
+#define MOONBIT_UV_FS_WALK_BUFFER 32768
+#endif
+
+// An open directory on the stack of the walk.
+typedef struct moonbit_uv_fs_walk_frame_s {
+#ifdef __linux__
+  int fd;
+  char *buffer;
+  int32_t position;
+  int32_t length;
+#else
+  DIR *dir;
+#endif
+  // Length of the path of the directory in the path buffer.
+  size_t prefix;
+  int32_t depth;
+  dev_t dev;
+  ino_t ino;
+} moonbit_uv_fs_walk_frame_t;
+#endif
+
+typedef struct moonbit_uv_fs_walk_s {
+  uv_work_t work;
+  uv_loop_t *loop;
+  moonbit_uv_fs_walk_cb_t *cb;
+  // Options.
+  int32_t max_depth;
+  int32_t batch_size;
+  bool follow;
+  bool stat;
+  moonbit_bytes_t *include;
+  moonbit_bytes_t *exclude;
+#ifndef _WIN32
+  // The stack of open directories.
+  moonbit_uv_fs_walk_frame_t *frames;
+  int32_t frames_count;
+  int32_t frames_capacity;
+#endif
+  // The path of the current entry, starting with the root; the paths reported
+  // are relative to the root.
+  char *path;
+  size_t root;
+  size_t path_capacity;
+  // The batch being filled by the job.
+  char *names;
+  size_t names_length;
+  size_t names_capacity;
+  int32_t *records;
+  int32_t count;
+  uv_stat_t *stats;
+  bool started;
+  bool stopped;
+  int32_t status;
+} moonbit_uv_fs_walk_t;
+
+#ifndef _WIN32
+static inline void
+moonbit_uv_fs_walk_pop(moonbit_uv_fs_walk_t *walk) {
+  moonbit_uv_fs_walk_frame_t *frame = &walk->frames[--walk->frames_count];
+#ifdef __linux__
+  close(frame->fd);
+  free(frame->buffer);
+#else
+  closedir(frame->dir);
+#endif
+}
+#endif
+
+static inline void
+moonbit_uv_fs_walk_finalize(void *object) {
+  moonbit_uv_fs_walk_t *walk = object;
+#ifndef _WIN32
+  while (walk->frames_count > 0) {
+    moonbit_uv_fs_walk_pop(walk);
+  }
+  free(walk->frames);
+#endif
+  free(walk->path);
+  free(walk->names);
+  free(walk->records);
+  free(walk->stats);
+  if (walk->include) {
+    moonbit_decref(walk->include);
+  }
+  if (walk->exclude) {
+    moonbit_decref(walk->exclude);
+  }
+  if (walk->cb) {
+    moonbit_decref(walk->cb);
+  }
+  if (walk->loop) {
+    moonbit_decref(walk->loop);
+  }
+}
+
+#ifndef _WIN32
+static inline bool
+moonbit_uv_fs_walk_match(moonbit_bytes_t *patterns, const char *name) {
+  int32_t count = Moonbit_array_length(patterns);
+  for (int32_t i = 0; i < count; i++) {
+    if (fnmatch((const char *)patterns[i], name, 0) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static inline int32_t
+moonbit_uv_fs_walk_reserve(char **buffer, size_t *capacity, size_t length) {
+  if (length <= *capacity) {
+    return 0;
+  }
+  size_t new_capacity = *capacity == 0 ? 256 : *capacity;
+  while (new_capacity < length) {
+    new_capacity *= 2;
+  }
+  char *new_buffer = realloc(*buffer, new_capacity);
+  if (new_buffer == NULL) {
+    return UV_ENOMEM;
+  }
+  *buffer = new_buffer;
+  *capacity = new_capacity;
+  return 0;
+}
+
+static inline int
+moonbit_uv_fs_walk_fd(moonbit_uv_fs_walk_frame_t *frame) {
+#ifdef __linux__
+  return frame->fd;
+#else
+  return dirfd(frame->dir);
+#endif
+}
+
+// Pushes the directory opened as `fd`, whose path is the current path.
+static inline int32_t
+moonbit_uv_fs_walk_push(moonbit_uv_fs_walk_t *walk, int fd, int32_t depth) {
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    int32_t status = uv_translate_sys_error(errno);
+    close(fd);
+    return status;
+  }
+  // Following symbolic links may lead back to a directory being walked.
+  if (walk->follow) {
+    for (int32_t i = 0; i < walk->frames_count; i++) {
+      if (walk->frames[i].dev == st.st_dev && walk->frames[i].ino == st.st_ino) {
+        close(fd);
+        return UV_ELOOP;
+      }
+    }
+  }
+  if (walk->frames_count == walk->frames_capacity) {
+    int32_t capacity =
+      walk->frames_capacity == 0 ? 16 : walk->frames_capacity * 2;
+    moonbit_uv_fs_walk_frame_t *frames =
+      realloc(walk->frames, sizeof(moonbit_uv_fs_walk_frame_t) * capacity);
+    if (frames == NULL) {
+      close(fd);
+      return UV_ENOMEM;
+    }
+    walk->frames = frames;
+    walk->frames_capacity = capacity;
+  }
+  moonbit_uv_fs_walk_frame_t *frame = &walk->frames[walk->frames_count];
+#ifdef __linux__
+  frame->buffer = malloc(MOONBIT_UV_FS_WALK_BUFFER);
+  if (frame->buffer == NULL) {
+    close(fd);
+    return UV_ENOMEM;
+  }
+  frame->fd = fd;
+  frame->position = 0;
+  frame->length = 0;
+#else
+  frame->dir = fdopendir(fd);
+  if (frame->dir == NULL) {
+    int32_t status = uv_translate_sys_error(errno);
+    close(fd);
+    return status;
+  }
+#endif
+  frame->prefix = strlen(walk->path);
+  frame->depth = depth;
+  frame->dev = st.st_dev;
+  frame->ino = st.st_ino;
+  walk->frames_count++;
+  return 0;
+}
+
+// Reads the next entry of `frame`. Returns 1 and sets `name` and `type` if
+// there is one, 0 at the end of the directory, or an error.
+static inline int32_t
+moonbit_uv_fs_walk_next(
+  moonbit_uv_fs_walk_frame_t *frame,
+  const char **name,
+  unsigned char *type
+) {
+#ifdef __linux__
+  if (frame->position >= frame->length) {
+    long length = syscall(
+      SYS_getdents64, frame->fd, frame->buffer, MOONBIT_UV_FS_WALK_BUFFER
+    );
+    if (length < 0) {
+      return uv_translate_sys_error(errno);
+    }
+    if (length == 0) {
+      return 0;
+    }
+    frame->position = 0;
+    frame->length = length;
+  }
+  moonbit_uv_linux_dirent64_t *dirent =
+    (moonbit_uv_linux_dirent64_t *)(frame->buffer + frame->position);
+  frame->position += dirent->d_reclen;
+  *name = dirent->d_name;
+  *type = dirent->d_type;
+  return 1;
+#else
+  errno = 0;
+  struct dirent *dirent = readdir(frame->dir);
+  if (dirent == NULL) {
+    return errno == 0 ? 0 : uv_translate_sys_error(errno);
+  }
+  *name = dirent->d_name;
+#ifdef DT_UNKNOWN
+  *type = dirent->d_type;
+#else
+  *type = 0;
+#endif
+  return 1;
+#endif
+}
+
+static inline uv_dirent_type_t
+moonbit_uv_fs_walk_type_of_dirent(unsigned char type) {
+  switch (type) {
+#ifdef DT_UNKNOWN
+  case DT_REG:
+    return UV_DIRENT_FILE;
+  case DT_DIR:
+    return UV_DIRENT_DIR;
+  case DT_LNK:
+    return UV_DIRENT_LINK;
+  case DT_FIFO:
+    return UV_DIRENT_FIFO;
+  case DT_SOCK:
+    return UV_DIRENT_SOCKET;
+  case DT_CHR:
+    return UV_DIRENT_CHAR;
+  case DT_BLK:
+    return UV_DIRENT_BLOCK;
+#endif
+  default:
+    return UV_DIRENT_UNKNOWN;
+  }
+}
+
+static inline uv_dirent_type_t
+moonbit_uv_fs_walk_type_of_mode(uint64_t mode) {
+  switch (mode & S_IFMT) {
+  case S_IFREG:
+    return UV_DIRENT_FILE;
+  case S_IFDIR:
+    return UV_DIRENT_DIR;
+  case S_IFLNK:
+    return UV_DIRENT_LINK;
+  case S_IFIFO:
+    return UV_DIRENT_FIFO;
+  case S_IFSOCK:
+    return UV_DIRENT_SOCKET;
+  case S_IFCHR:
+    return UV_DIRENT_CHAR;
+  case S_IFBLK:
+    return UV_DIRENT_BLOCK;
+  default:
+    return UV_DIRENT_UNKNOWN;
+  }
+}
+
+// Handles the entry `name` of the directory on top of the stack.
+static inline int32_t
+moonbit_uv_fs_walk_entry(
+  moonbit_uv_fs_walk_t *walk,
+  const char *name,
+  unsigned char dirent_type
+) {
+  moonbit_uv_fs_walk_frame_t *frame = &walk->frames[walk->frames_count - 1];
+  if (name[0] == '.' &&
+      (name[1] == 0 || (name[1] == '.' && name[2] == 0))) {
+    return 0;
+  }
+  if (walk->exclude && moonbit_uv_fs_walk_match(walk->exclude, name)) {
+    return 0;
+  }
+  int32_t depth = frame->depth + 1;
+  size_t name_length = strlen(name);
+  int32_t status = moonbit_uv_fs_walk_reserve(
+    &walk->path, &walk->path_capacity, frame->prefix + name_length + 2
+  );
+  if (status < 0) {
+    return status;
+  }
+  size_t length = frame->prefix;
+  if (length > 0 && walk->path[length - 1] != '/') {
+    walk->path[length++] = '/';
+  }
+  memcpy(walk->path + length, name, name_length + 1);
+  length += name_length;
+
+  // The type reported by the directory saves a `stat()` per entry, unless it
+  // is unknown to the file system or a symbolic link must be resolved.
+  uv_dirent_type_t type = moonbit_uv_fs_walk_type_of_dirent(dirent_type);
+  uv_stat_t statbuf;
+  int32_t entry_status = 0;
+  if (walk->stat || type == UV_DIRENT_UNKNOWN ||
+      (type == UV_DIRENT_LINK && walk->follow)) {
+    uv_fs_t req;
+    entry_status = walk->follow ? uv_fs_stat(NULL, &req, walk->path, NULL)
+                                : uv_fs_lstat(NULL, &req, walk->path, NULL);
+    if (entry_status < 0 && walk->follow) {
+      // A dangling link is reported as a link.
+      uv_fs_req_cleanup(&req);
+      entry_status = uv_fs_lstat(NULL, &req, walk->path, NULL);
+    }
+    if (entry_status == 0) {
+      memcpy(&statbuf, &req.statbuf, sizeof(uv_stat_t));
+      type = moonbit_uv_fs_walk_type_of_mode(statbuf.st_mode);
+    } else {
+      memset(&statbuf, 0, sizeof(uv_stat_t));
+    }
+    uv_fs_req_cleanup(&req);
+  }
+
+  int32_t *record = NULL;
+  if (walk->include == NULL ||
+      moonbit_uv_fs_walk_match(walk->include, name)) {
+    size_t relative = length - walk->root;
+    status = moonbit_uv_fs_walk_reserve(
+      &walk->names, &walk->names_capacity, walk->names_length + relative
+    );
+    if (status < 0) {
+      return status;
+    }
+    memcpy(
+      walk->names + walk->names_length, walk->path + walk->root, relative
+    );
+    record = &walk->records[walk->count * MOONBIT_UV_FS_WALK_RECORD];
+    record[0] = walk->names_length;
+    record[1] = relative;
+    record[2] = type;
+    record[3] = depth;
+    record[4] = entry_status;
+    if (walk->stat) {
+      walk->stats[walk->count] = statbuf;
+    }
+    walk->names_length += relative;
+    walk->count++;
+  }
+
+  if (type == UV_DIRENT_DIR &&
+      (walk->max_depth < 0 || depth < walk->max_depth)) {
+    int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+    if (!walk->follow) {
+      flags |= O_NOFOLLOW;
+    }
+    int fd = openat(moonbit_uv_fs_walk_fd(frame), name, flags);
+    status = fd < 0 ? uv_translate_sys_error(errno)
+                    : moonbit_uv_fs_walk_push(walk, fd, depth);
+    // The directory is still reported, with the reason it was not walked.
+    if (status < 0 && record != NULL) {
+      record[4] = status;
+    }
+  }
+  return 0;
+}
+#endif
+
+static inline void
+moonbit_uv_fs_walk_work_cb(uv_work_t *work) {
+  moonbit_uv_fs_walk_t *walk = containerof(work, moonbit_uv_fs_walk_t, work);
+#ifdef _WIN32
+  walk->status = UV_ENOSYS;
+#else
+  if (!walk->started) {
+    walk->started = true;
+    int fd = open(walk->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    int32_t status = fd < 0 ? uv_translate_sys_error(errno)
+                            : moonbit_uv_fs_walk_push(walk, fd, 0);
+    if (status < 0) {
+      walk->status = status;
+      return;
+    }
+  }
+  while (walk->count < walk->batch_size && walk->frames_count > 0) {
+    const char *name;
+    unsigned char type;
+    int32_t status = moonbit_uv_fs_walk_next(
+      &walk->frames[walk->frames_count - 1], &name, &type
+    );
+    if (status <= 0) {
+      // A directory that fails to be read is reported as far as it was read.
+      moonbit_uv_fs_walk_pop(walk);
+      continue;
+    }
+    status = moonbit_uv_fs_walk_entry(walk, name, type);
+    if (status < 0) {
+      walk->status = status;
+      return;
+    }
+  }
+#endif
+}
+
+static inline void
+moonbit_uv_fs_walk_after_work_cb(uv_work_t *work, int status) {
+  moonbit_uv_fs_walk_t *walk = containerof(work, moonbit_uv_fs_walk_t, work);
+  if (status < 0 && walk->status == 0) {
+    walk->status = status;
+  }
+  if (walk->stopped) {
+    moonbit_decref(walk);
+    return;
+  }
+  if (walk->status < 0) {
+    moonbit_incref(walk->cb);
+    walk->cb->code(
+      walk->cb, walk->status, moonbit_make_bytes(0, 0),
+      moonbit_make_int32_array(0, 0), moonbit_make_bytes(0, 0), true
+    );
+    moonbit_decref(walk);
+    return;
+  }
+  if (walk->count > 0) {
+    moonbit_bytes_t names = moonbit_make_bytes(walk->names_length, 0);
+    memcpy(names, walk->names, walk->names_length);
+    int32_t *records =
+      moonbit_make_int32_array(walk->count * MOONBIT_UV_FS_WALK_RECORD, 0);
+    memcpy(
+      records, walk->records,
+      sizeof(int32_t) * walk->count * MOONBIT_UV_FS_WALK_RECORD
+    );
+    moonbit_bytes_t stats =
+      moonbit_make_bytes(walk->stat ? sizeof(uv_stat_t) * walk->count : 0, 0);
+    if (walk->stat) {
+      memcpy(stats, walk->stats, sizeof(uv_stat_t) * walk->count);
+    }
+    walk->names_length = 0;
+    walk->count = 0;
+    moonbit_incref(walk->cb);
+    walk->cb->code(walk->cb, 0, names, records, stats, false);
+    // The callback may have stopped the walk.
+    if (walk->stopped) {
+      moonbit_decref(walk);
+      return;
+    }
+  }
+  bool done = true;
+#ifndef _WIN32
+  done = walk->frames_count == 0;
+#endif
+  if (!done) {
+    status = uv_queue_work(
+      walk->loop, &walk->work, moonbit_uv_fs_walk_work_cb,
+      moonbit_uv_fs_walk_after_work_cb
+    );
+    if (status == 0) {
+      return;
+    }
+    walk->status = status;
+  }
+  moonbit_incref(walk->cb);
+  walk->cb->code(
+    walk->cb, walk->status, moonbit_make_bytes(0, 0),
+    moonbit_make_int32_array(0, 0), moonbit_make_bytes(0, 0), true
+  );
+  moonbit_decref(walk);
+}
+
+MOONBIT_FFI_EXPORT
+moonbit_uv_fs_walk_t *
+moonbit_uv_fs_walk_make(void) {
+  moonbit_uv_fs_walk_t *walk = moonbit_make_external_object(
+    moonbit_uv_fs_walk_finalize, sizeof(moonbit_uv_fs_walk_t)
+  );
+  memset(walk, 0, sizeof(moonbit_uv_fs_walk_t));
+  return walk;
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_fs_walk_start(
+  uv_loop_t *loop,
+  moonbit_uv_fs_walk_t *walk,
+  moonbit_bytes_t root,
+  int32_t max_depth,
+  int32_t batch_size,
+  bool follow,
+  bool stat,
+  moonbit_bytes_t *include,
+  moonbit_bytes_t *exclude,
+  moonbit_uv_fs_walk_cb_t *cb
+) {
+  // Ownership of everything is transferred to the walk, which frees it when
+  // finalized.
+  walk->loop = loop;
+  walk->cb = cb;
+  walk->include = Moonbit_array_length(include) > 0 ? include : NULL;
+  walk->exclude = Moonbit_array_length(exclude) > 0 ? exclude : NULL;
+  if (walk->include == NULL) {
+    moonbit_decref(include);
+  }
+  if (walk->exclude == NULL) {
+    moonbit_decref(exclude);
+  }
+  walk->max_depth = max_depth;
+  walk->batch_size = batch_size;
+  walk->follow = follow;
+  walk->stat = stat;
+  size_t root_length = strlen((const char *)root);
+  walk->path_capacity = root_length + 1;
+  walk->path = malloc(walk->path_capacity);
+  walk->records =
+    malloc(sizeof(int32_t) * batch_size * MOONBIT_UV_FS_WALK_RECORD);
+  walk->stats = stat ? malloc(sizeof(uv_stat_t) * batch_size) : NULL;
+  if (walk->path == NULL || walk->records == NULL ||
+      (stat && walk->stats == NULL)) {
+    moonbit_decref(root);
+    moonbit_decref(walk);
+    return UV_ENOMEM;
+  }
+  memcpy(walk->path, root, root_length + 1);
+  moonbit_decref(root);
+  walk->root = root_length;
+  if (root_length > 0 && walk->path[root_length - 1] != '/') {
+    walk->root++;
+  }
+  int32_t status = uv_queue_work(
+    loop, &walk->work, moonbit_uv_fs_walk_work_cb,
+    moonbit_uv_fs_walk_after_work_cb
+  );
+  if (status < 0) {
+    moonbit_decref(walk);
+  }
+  return status;
+}
+
+MOONBIT_FFI_EXPORT
+void
+moonbit_uv_fs_walk_stop(moonbit_uv_fs_walk_t *walk) {
+  walk->stopped = true;
+}
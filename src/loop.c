@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include "loop.h"
+
 #include "moonbit.h"
 #include "uv#include#uv.h"
 #include "uv.h"
@@ -54,6 +56,9 @@ MOONBIT_FFI_EXPORT
 int32_t
 moonbit_uv_loop_close(uv_loop_t *loop) {
   int result = uv_loop_close(loop);
+  if (result == 0) {
+    moonbit_uv_loop_data_destroy(loop);
+  }
   moonbit_decref(loop);
   return result;
 }
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2026 International Digital Economy Academy
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MOONBIT_UV_LOOP_H
+#define MOONBIT_UV_LOOP_H
+
+#include "buffer_pool.h"
+#include "moonbit.h"
+#include "req_pool.h"
+#include "uv#include#uv.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Size of the scratch buffer shared by all streams read with
+// `moonbit_uv_read_start_shared()`.
+#define MOONBIT_UV_LOOP_READ_SCRATCH_SIZE 65536
+
+// Traffic counters of a stream, or of all the streams of a loop.
+typedef struct moonbit_uv_stream_stats_s {
+  uint64_t bytes_read;
+  uint64_t reads;
+  uint64_t bytes_written;
+  uint64_t writes;
+  uint64_t write_errors;
+  uint64_t write_queue_high_water;
+  // Time from queueing a write to its completion, in nanoseconds.
+  uint64_t write_latency_total;
+  uint64_t write_latency_max;
+} moonbit_uv_stream_stats_t;
+
+// Per-loop state owned by the binding. It is stored in `loop->data`, created on
+// first use and released by `moonbit_uv_loop_close()`.
+typedef struct moonbit_uv_loop_data_s {
+  moonbit_uv_buffer_pool_t read_pool;
+  char *read_scratch;
+  bool read_scratch_in_use;
+  // Set by `moonbit_uv_loop_enable_stream_stats()`. Streams only maintain
+  // counters while it is set.
+  bool stream_stats_enabled;
+  moonbit_uv_stream_stats_t stream_stats;
+  // Idle request objects, reused by the requests of the loop.
+  moonbit_uv_req_pool_t fs_pool;
+  moonbit_uv_req_pool_t write_pool;
+  moonbit_uv_req_pool_t udp_send_pool;
+} moonbit_uv_loop_data_t;
+
+static inline moonbit_uv_loop_data_t *
+moonbit_uv_loop_data(uv_loop_t *loop) {
+  if (loop->data == NULL) {
+    loop->data = calloc(1, sizeof(moonbit_uv_loop_data_t));
+  }
+  return loop->data;
+}
+
+static inline void
+moonbit_uv_loop_data_destroy(uv_loop_t *loop) {
+  moonbit_uv_loop_data_t *data = loop->data;
+  if (data == NULL) {
+    return;
+  }
+  moonbit_uv_buffer_pool_destroy(&data->read_pool);
+  moonbit_uv_req_pool_destroy(&data->fs_pool);
+  moonbit_uv_req_pool_destroy(&data->write_pool);
+  moonbit_uv_req_pool_destroy(&data->udp_send_pool);
+  free(data->read_scratch);
+  free(data);
+  loop->data = NULL;
+}
+
+#endif // MOONBIT_UV_LOOP_H
@@ -0,0 +1,293 @@
+/*
+ * Copyright 2026 International Digital Economy Academy
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "moonbit.h"
+#include "uv#include#uv.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uv.h"
+
+typedef struct moonbit_uv_mapped_file_s {
+  // The mapping, which starts at the page boundary preceding `data`.
+  void *base;
+  size_t size;
+  uint8_t *data;
+  int64_t length;
+  // Owned, and closed with the mapping: `fsync()` needs a descriptor of the
+  // file after the caller of `moonbit_uv_mapped_file_map` closed theirs.
+  int32_t fd;
+  bool writable;
+} moonbit_uv_mapped_file_t;
+
+static inline void
+moonbit_uv_mapped_file_release(moonbit_uv_mapped_file_t *file) {
+#ifndef _WIN32
+  if (file->base) {
+    munmap(file->base, file->size);
+  }
+  if (file->fd >= 0) {
+    close(file->fd);
+  }
+#endif
+  file->base = NULL;
+  file->size = 0;
+  file->data = NULL;
+  file->length = 0;
+  file->fd = -1;
+}
+
+static inline void
+moonbit_uv_mapped_file_finalize(void *object) {
+  moonbit_uv_mapped_file_release((moonbit_uv_mapped_file_t *)object);
+}
+
+MOONBIT_FFI_EXPORT
+moonbit_uv_mapped_file_t *
+moonbit_uv_mapped_file_make(void) {
+  moonbit_uv_mapped_file_t *file = moonbit_make_external_object(
+    moonbit_uv_mapped_file_finalize, sizeof(moonbit_uv_mapped_file_t)
+  );
+  memset(file, 0, sizeof(moonbit_uv_mapped_file_t));
+  file->fd = -1;
+  return file;
+}
+
+#ifndef _WIN32
+static inline int32_t
+moonbit_uv_mapped_file_advise(moonbit_uv_mapped_file_t *file, int32_t hint) {
+  if (file->base == NULL) {
+    return 0;
+  }
+  int advice;
+  switch (hint) {
+  case 0:
+    advice = MADV_RANDOM;
+    break;
+  case 1:
+    advice = MADV_SEQUENTIAL;
+    break;
+  default:
+    advice = MADV_NORMAL;
+    break;
+  }
+  if (madvise(file->base, file->size, advice) < 0) {
+    return uv_translate_sys_error(errno);
+  }
+  return 0;
+}
+#endif
+
+#ifndef _WIN32
+// Maps `length` bytes of `fd` from `offset`, or up to the end of the file if
+// `length` is negative. `hint` is the index of an `AccessHint`, or -1. On
+// success, `file` takes over `fd`.
+static inline int32_t
+moonbit_uv_mapped_file_map_fd(
+  moonbit_uv_mapped_file_t *file,
+  int32_t fd,
+  int64_t offset,
+  int64_t length,
+  bool writable,
+  int32_t hint
+) {
+  if (offset < 0) {
+    return UV_EINVAL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    return uv_translate_sys_error(errno);
+  }
+  if (length < 0) {
+    length = st.st_size > offset ? st.st_size - offset : 0;
+  } else if (offset > st.st_size || length > st.st_size - offset) {
+    // Accessing the pages past the end of the file raises `SIGBUS`.
+    return UV_EINVAL;
+  }
+  if (length > 0) {
+    // The offset of a mapping must be a multiple of the page size.
+    int64_t page_size = sysconf(_SC_PAGESIZE);
+    int64_t delta = offset % page_size;
+    int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *base =
+      mmap(NULL, length + delta, prot, MAP_SHARED, fd, offset - delta);
+    if (base == MAP_FAILED) {
+      return uv_translate_sys_error(errno);
+    }
+    file->base = base;
+    file->size = length + delta;
+    file->data = (uint8_t *)base + delta;
+    if (hint >= 0) {
+      // Advice is an optimization: failing to give it is not an error.
+      moonbit_uv_mapped_file_advise(file, hint);
+    }
+  }
+  // `mmap()` rejects empty mappings: an empty range maps to nothing.
+  file->fd = fd;
+  file->writable = writable;
+  file->length = length;
+  return 0;
+}
+#endif
+
+// Maps a range of `fd`, which stays owned by the caller: the mapping keeps a
+// duplicate of it.
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_mapped_file_map(
+  moonbit_uv_mapped_file_t *file,
+  int32_t fd,
+  int64_t offset,
+  int64_t length,
+  bool writable,
+  int32_t hint
+) {
+#ifdef _WIN32
+  return UV_ENOSYS;
+#else
+  int32_t copy = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (copy < 0) {
+    return uv_translate_sys_error(errno);
+  }
+  int32_t status =
+    moonbit_uv_mapped_file_map_fd(file, copy, offset, length, writable, hint);
+  if (status < 0) {
+    close(copy);
+  }
+  return status;
+#endif
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_mapped_file_open(
+  moonbit_uv_mapped_file_t *file,
+  moonbit_bytes_t path,
+  bool writable,
+  int32_t hint
+) {
+#ifdef _WIN32
+  moonbit_decref(path);
+  return UV_ENOSYS;
+#else
+  uv_fs_t req;
+  int32_t fd = uv_fs_open(
+    NULL, &req, (const char *)path, writable ? UV_FS_O_RDWR : UV_FS_O_RDONLY,
+    0, NULL
+  );
+  uv_fs_req_cleanup(&req);
+  moonbit_decref(path);
+  if (fd < 0) {
+    return fd;
+  }
+  int32_t status =
+    moonbit_uv_mapped_file_map_fd(file, fd, 0, -1, writable, hint);
+  if (status < 0) {
+    close(fd);
+  }
+  return status;
+#endif
+}
+
+MOONBIT_FFI_EXPORT
+void
+moonbit_uv_mapped_file_unmap(moonbit_uv_mapped_file_t *file) {
+  moonbit_uv_mapped_file_release(file);
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_mapped_file_madvise(moonbit_uv_mapped_file_t *file, int32_t hint) {
+#ifdef _WIN32
+  return UV_ENOSYS;
+#else
+  return moonbit_uv_mapped_file_advise(file, hint);
+#endif
+}
+
+// Flushes the mapping to the file: with `full`, the metadata of the file is
+// flushed as well, as with `Sync::Full` for `OpenFlags`.
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_mapped_file_sync(moonbit_uv_mapped_file_t *file, bool full) {
+#ifdef _WIN32
+  return UV_ENOSYS;
+#else
+  if (file->base == NULL) {
+    return 0;
+  }
+  if (msync(file->base, file->size, MS_SYNC) < 0) {
+    return uv_translate_sys_error(errno);
+  }
+  if (full && fsync(file->fd) < 0) {
+    return uv_translate_sys_error(errno);
+  }
+  return 0;
+#endif
+}
+
+MOONBIT_FFI_EXPORT
+int64_t
+moonbit_uv_mapped_file_length(moonbit_uv_mapped_file_t *file) {
+  return file->length;
+}
+
+MOONBIT_FFI_EXPORT
+bool
+moonbit_uv_mapped_file_writable(moonbit_uv_mapped_file_t *file) {
+  return file->writable;
+}
+
+// The accessors below are bounds-checked by the caller.
+
+MOONBIT_FFI_EXPORT
+uint8_t
+moonbit_uv_mapped_file_get(moonbit_uv_mapped_file_t *file, int64_t index) {
+  return file->data[index];
+}
+
+MOONBIT_FFI_EXPORT
+void
+moonbit_uv_mapped_file_read(
+  moonbit_uv_mapped_file_t *file,
+  int64_t offset,
+  moonbit_bytes_t bytes,
+  int32_t bytes_offset,
+  int32_t length
+) {
+  memcpy(bytes + bytes_offset, file->data + offset, length);
+}
+
+MOONBIT_FFI_EXPORT
+void
+moonbit_uv_mapped_file_write(
+  moonbit_uv_mapped_file_t *file,
+  int64_t offset,
+  moonbit_bytes_t bytes,
+  int32_t bytes_offset,
+  int32_t length
+) {
+  memcpy(file->data + offset, bytes + bytes_offset, length);
+}
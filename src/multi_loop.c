@@ -0,0 +1,206 @@
+/*
+ * Copyright 2026 International Digital Economy Academy
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "moonbit.h"
+#include "uv#include#uv.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "uv.h"
+
+#if __STDC_VERSION__ >= 201112L
+#include <stdatomic.h>
+#endif
+
+// State shared by the loops of a `MultiLoopServer` and the thread that
+// controls it. The block is reference counted with `arc`, so that every
+// thread can hold its own MoonBit object pointing to it.
+typedef struct moonbit_uv_multi_loop_s {
+  struct {
+    int32_t arc;
+    uv_mutex_t mutex;
+    bool stopping;
+    int32_t size;
+    // Wakes up each loop to stop it. Guarded by `mutex`.
+    uv_async_t **asyncs;
+#if __STDC_VERSION__ >= 201112L
+    _Atomic uint64_t *accepts;
+#else
+    uint64_t *accepts;
+#endif
+  } *block;
+} moonbit_uv_multi_loop_t;
+
+static inline void
+moonbit_uv_multi_loop_finalize(void *object) {
+  moonbit_uv_multi_loop_t *multi_loop = object;
+  if (multi_loop->block) {
+    uv_mutex_lock(&multi_loop->block->mutex);
+    int32_t arc = multi_loop->block->arc;
+    multi_loop->block->arc = arc - 1;
+    uv_mutex_unlock(&multi_loop->block->mutex);
+    if (arc > 1) {
+      return;
+    }
+    uv_mutex_destroy(&multi_loop->block->mutex);
+    free(multi_loop->block->asyncs);
+    free((void *)multi_loop->block->accepts);
+    free(multi_loop->block);
+  }
+}
+
+MOONBIT_FFI_EXPORT
+moonbit_uv_multi_loop_t *
+moonbit_uv_multi_loop_make(void) {
+  moonbit_uv_multi_loop_t *multi_loop =
+    (moonbit_uv_multi_loop_t *)moonbit_make_external_object(
+      moonbit_uv_multi_loop_finalize, sizeof(moonbit_uv_multi_loop_t)
+    );
+  memset(multi_loop, 0, sizeof(moonbit_uv_multi_loop_t));
+  return multi_loop;
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_multi_loop_init(moonbit_uv_multi_loop_t *multi_loop, int32_t size) {
+  int status = 0;
+  multi_loop->block = calloc(1, sizeof(*multi_loop->block));
+  if (multi_loop->block == NULL) {
+    status = UV_ENOMEM;
+    goto fail_to_alloc_block;
+  }
+  multi_loop->block->asyncs = calloc(size, sizeof(uv_async_t *));
+  multi_loop->block->accepts = calloc(size, sizeof(uint64_t));
+  if (multi_loop->block->asyncs == NULL ||
+      multi_loop->block->accepts == NULL) {
+    status = UV_ENOMEM;
+    goto fail_to_alloc_arrays;
+  }
+  status = uv_mutex_init(&multi_loop->block->mutex);
+  if (status < 0) {
+    goto fail_to_alloc_arrays;
+  }
+  multi_loop->block->arc = 1;
+  multi_loop->block->size = size;
+  goto success;
+
+fail_to_alloc_arrays:
+  free(multi_loop->block->asyncs);
+  free((void *)multi_loop->block->accepts);
+  free(multi_loop->block);
+  multi_loop->block = NULL;
+fail_to_alloc_block:
+success:
+  moonbit_decref(multi_loop);
+  return status;
+}
+
+MOONBIT_FFI_EXPORT
+void
+moonbit_uv_multi_loop_copy(
+  moonbit_uv_multi_loop_t *self,
+  moonbit_uv_multi_loop_t *other
+) {
+  uv_mutex_lock(&self->block->mutex);
+  self->block->arc += 1;
+  uv_mutex_unlock(&self->block->mutex);
+  other->block = self->block;
+  moonbit_decref(self);
+  moonbit_decref(other);
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_multi_loop_register(
+  moonbit_uv_multi_loop_t *multi_loop,
+  int32_t index,
+  uv_async_t *async
+) {
+  // The async handle is kept alive by its loop until it is closed, which only
+  // happens after `moonbit_uv_multi_loop_unregister()`.
+  int32_t status = 0;
+  uv_mutex_lock(&multi_loop->block->mutex);
+  if (multi_loop->block->stopping) {
+    status = UV_ECANCELED;
+  } else {
+    multi_loop->block->asyncs[index] = async;
+  }
+  uv_mutex_unlock(&multi_loop->block->mutex);
+  moonbit_decref(multi_loop);
+  moonbit_decref(async);
+  return status;
+}
+
+MOONBIT_FFI_EXPORT
+void
+moonbit_uv_multi_loop_unregister(
+  moonbit_uv_multi_loop_t *multi_loop,
+  int32_t index
+) {
+  uv_mutex_lock(&multi_loop->block->mutex);
+  multi_loop->block->asyncs[index] = NULL;
+  uv_mutex_unlock(&multi_loop->block->mutex);
+  moonbit_decref(multi_loop);
+}
+
+MOONBIT_FFI_EXPORT
+void
+moonbit_uv_multi_loop_stop(moonbit_uv_multi_loop_t *multi_loop) {
+  uv_mutex_lock(&multi_loop->block->mutex);
+  multi_loop->block->stopping = true;
+  for (int32_t i = 0; i < multi_loop->block->size; i++) {
+    if (multi_loop->block->asyncs[i]) {
+      uv_async_send(multi_loop->block->asyncs[i]);
+    }
+  }
+  uv_mutex_unlock(&multi_loop->block->mutex);
+  moonbit_decref(multi_loop);
+}
+
+MOONBIT_FFI_EXPORT
+void
+moonbit_uv_multi_loop_accepted(
+  moonbit_uv_multi_loop_t *multi_loop,
+  int32_t index
+) {
+#if __STDC_VERSION__ >= 201112L
+  atomic_fetch_add_explicit(
+    &multi_loop->block->accepts[index], 1, memory_order_relaxed
+  );
+#else
+  uv_mutex_lock(&multi_loop->block->mutex);
+  multi_loop->block->accepts[index] += 1;
+  uv_mutex_unlock(&multi_loop->block->mutex);
+#endif
+}
+
+MOONBIT_FFI_EXPORT
+uint64_t
+moonbit_uv_multi_loop_accept_count(
+  moonbit_uv_multi_loop_t *multi_loop,
+  int32_t index
+) {
+#if __STDC_VERSION__ >= 201112L
+  return atomic_load_explicit(
+    &multi_loop->block->accepts[index], memory_order_relaxed
+  );
+#else
+  uv_mutex_lock(&multi_loop->block->mutex);
+  uint64_t accepts = multi_loop->block->accepts[index];
+  uv_mutex_unlock(&multi_loop->block->mutex);
+  return accepts;
+#endif
+}
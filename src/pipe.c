@@ -21,10 +21,6 @@
 #include "uv.h"
 #include <string.h>
 
-typedef struct moonbit_uv_pipe_s {
-  uv_pipe_t pipe;
-} moonbit_uv_pipe_t;
-
 static inline void
 moonbit_uv_pipe_finalize(void *object) {
   moonbit_uv_pipe_t *pipe = (moonbit_uv_pipe_t *)object;
@@ -36,6 +32,7 @@ moonbit_uv_pipe_finalize(void *object) {
     moonbit_decref(pipe->pipe.loop);
     pipe->pipe.loop = NULL;
   }
+  free(pipe->stats);
 }
 
 MOONBIT_FFI_EXPORT
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2026 International Digital Economy Academy
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "req_pool.h"
+
+#include "loop.h"
+#include "moonbit.h"
+#include "uv#include#uv.h"
+#include "uv.h"
+
+MOONBIT_FFI_EXPORT
+void
+moonbit_uv_loop_req_pool_stats(
+  uv_loop_t *loop,
+  int32_t kind,
+  uint64_t *stats
+) {
+  moonbit_uv_loop_data_t *data = loop->data;
+  if (data) {
+    switch (kind) {
+    case 0:
+      moonbit_uv_req_pool_stats(&data->fs_pool, stats);
+      break;
+    case 1:
+      moonbit_uv_req_pool_stats(&data->write_pool, stats);
+      break;
+    case 2:
+      moonbit_uv_req_pool_stats(&data->udp_send_pool, stats);
+      break;
+    }
+  }
+  moonbit_decref(loop);
+  moonbit_decref(stats);
+}
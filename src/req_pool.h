@@ -0,0 +1,89 @@
+/*
+ * Copyright 2026 International Digital Economy Academy
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MOONBIT_UV_REQ_POOL_H
+#define MOONBIT_UV_REQ_POOL_H
+
+#include "moonbit.h"
+
+#include "uv.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Maximum number of idle requests kept per pool.
+#define MOONBIT_UV_REQ_POOL_CAPACITY 64
+
+// Idle request objects of one type (`Fs`, `Write` or `UdpSend`), reset and
+// ready to be reused instead of allocating a new external object per request.
+typedef struct moonbit_uv_req_pool_s {
+  int32_t count;
+  void *free[MOONBIT_UV_REQ_POOL_CAPACITY];
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t recycled;
+  uint64_t retained;
+} moonbit_uv_req_pool_t;
+
+// Takes an idle request from the pool, or returns `NULL` if the caller must
+// allocate one.
+static inline void *
+moonbit_uv_req_pool_acquire(moonbit_uv_req_pool_t *pool) {
+  if (pool->count > 0) {
+    pool->hits++;
+    return pool->free[--pool->count];
+  }
+  pool->misses++;
+  return NULL;
+}
+
+// Tells whether `req`, whose callbacks have completed, can be reset and given
+// back to the pool: only when the caller holds the last reference to it. A
+// request still referenced from MoonBit (for example, because `Loop::fs_open`
+// returned it and the caller kept it) is left to RC.
+static inline bool
+moonbit_uv_req_pool_recyclable(moonbit_uv_req_pool_t *pool, void *req) {
+  if (Moonbit_object_header(req)->rc != 1) {
+    pool->retained++;
+    return false;
+  }
+  return pool->count < MOONBIT_UV_REQ_POOL_CAPACITY;
+}
+
+// Gives a request accepted by `moonbit_uv_req_pool_recyclable()`, once reset,
+// to the pool, which takes over the reference of the caller.
+static inline void
+moonbit_uv_req_pool_release(moonbit_uv_req_pool_t *pool, void *req) {
+  pool->free[pool->count++] = req;
+  pool->recycled++;
+}
+
+static inline void
+moonbit_uv_req_pool_destroy(moonbit_uv_req_pool_t *pool) {
+  while (pool->count > 0) {
+    moonbit_decref(pool->free[--pool->count]);
+  }
+}
+
+static inline void
+moonbit_uv_req_pool_stats(moonbit_uv_req_pool_t *pool, uint64_t *stats) {
+  stats[0] = pool->hits;
+  stats[1] = pool->misses;
+  stats[2] = pool->recycled;
+  stats[3] = pool->retained;
+  stats[4] = pool->count;
+}
+
+#endif // MOONBIT_UV_REQ_POOL_H
@@ -16,11 +16,16 @@
 
 #include "stream.h"
 
+#include "buffer_pool.h"
+#include "framer.h"
 #include "handle.h"
+#include "loop.h"
 #include "moonbit.h"
 #include "uv#include#uv.h"
 #include "uv.h"
+#include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 
 typedef struct moonbit_uv_read_cb {
   int32_t (*code)(
@@ -33,12 +38,42 @@ typedef struct moonbit_uv_read_cb {
   );
 } moonbit_uv_read_cb_t;
 
+typedef struct moonbit_uv_read_bytes_cb {
+  int32_t (*code)(
+    struct moonbit_uv_read_bytes_cb *,
+    uv_stream_t *stream,
+    ssize_t nread,
+    moonbit_bytes_t buf
+  );
+} moonbit_uv_read_bytes_cb_t;
+
+typedef struct moonbit_uv_read_frames_cb {
+  int32_t (*code)(
+    struct moonbit_uv_read_frames_cb *,
+    uv_stream_t *stream,
+    int32_t status,
+    moonbit_bytes_t frames,
+    int32_t *frame_lengths
+  );
+} moonbit_uv_read_frames_cb_t;
+
+typedef struct moonbit_uv_relay_s moonbit_uv_relay_t;
+
 typedef struct moonbit_uv_stream_data_s {
   moonbit_bytes_t bytes;
   moonbit_uv_alloc_cb_t *alloc_cb;
   moonbit_uv_read_cb_t *read_cb;
+  moonbit_uv_read_bytes_cb_t *read_bytes_cb;
+  moonbit_uv_read_frames_cb_t *read_frames_cb;
+  moonbit_uv_framer_t *framer;
+  moonbit_uv_relay_t *relay;
+  // Size class of the next buffer taken from the loop's read pool.
+  int32_t pool_class;
 } moonbit_uv_stream_data_t;
 
+static inline void
+moonbit_uv_relay_detach(moonbit_uv_relay_t *relay);
+
 static inline void
 moonbit_uv_stream_data_finalize(void *object) {
   moonbit_uv_tracef("object = %p\n", object);
@@ -49,6 +84,18 @@ moonbit_uv_stream_data_finalize(void *object) {
   if (data->read_cb) {
     moonbit_decref(data->read_cb);
   }
+  if (data->read_bytes_cb) {
+    moonbit_decref(data->read_bytes_cb);
+  }
+  if (data->read_frames_cb) {
+    moonbit_decref(data->read_frames_cb);
+  }
+  if (data->framer) {
+    moonbit_uv_framer_free(data->framer);
+  }
+  if (data->relay) {
+    moonbit_uv_relay_detach(data->relay);
+  }
   if (data->alloc_cb) {
     moonbit_decref(data->alloc_cb);
   }
@@ -99,6 +146,7 @@ moonbit_uv_read_start_read_cb(
   const uv_buf_t *buf
 ) {
   moonbit_uv_tracef("stream = %p\n", (void *)stream);
+  moonbit_uv_stream_stats_record_read(stream, nread);
   moonbit_uv_stream_data_t *stream_data = stream->data;
   moonbit_uv_read_cb_t *read_cb = stream_data->read_cb;
   moonbit_bytes_t buf_base = stream_data->bytes;
@@ -149,6 +197,490 @@ moonbit_uv_read_start(
   return status;
 }
 
+static inline void
+moonbit_uv_read_start_pooled_alloc_cb(
+  uv_handle_t *handle,
+  size_t suggested_size,
+  uv_buf_t *buf
+) {
+  moonbit_uv_ignore(suggested_size);
+  moonbit_uv_stream_data_t *stream_data = handle->data;
+  moonbit_uv_loop_data_t *loop_data = handle->loop->data;
+  moonbit_bytes_t bytes = moonbit_uv_buffer_pool_acquire(
+    &loop_data->read_pool, stream_data->pool_class
+  );
+  buf->base = (char *)bytes;
+  buf->len = Moonbit_array_length(bytes);
+  stream_data->bytes = bytes;
+}
+
+static inline void
+moonbit_uv_read_start_pooled_read_cb(
+  uv_stream_t *stream,
+  ssize_t nread,
+  const uv_buf_t *buf
+) {
+  moonbit_uv_tracef("stream = %p\n", (void *)stream);
+  moonbit_uv_stream_stats_record_read(stream, nread);
+  moonbit_uv_stream_data_t *stream_data = stream->data;
+  moonbit_uv_loop_data_t *loop_data = stream->loop->data;
+  moonbit_uv_read_bytes_cb_t *read_cb = stream_data->read_bytes_cb;
+  moonbit_bytes_t bytes = stream_data->bytes;
+  stream_data->bytes = NULL;
+  if (bytes && nread > 0) {
+    // Grow the size class when the buffer was filled up, shrink it when most
+    // of the buffer was left unused.
+    if ((size_t)nread == buf->len &&
+        stream_data->pool_class < MOONBIT_UV_BUFFER_POOL_CLASSES - 1) {
+      stream_data->pool_class++;
+    } else if ((size_t)nread <= buf->len / 4 && stream_data->pool_class > 0) {
+      stream_data->pool_class--;
+    }
+  }
+  if (nread != 0) {
+    moonbit_bytes_t data = NULL;
+    if (nread > 0) {
+      data = bytes;
+      moonbit_incref(data);
+    }
+    moonbit_incref(read_cb);
+    moonbit_incref(stream);
+    read_cb->code(read_cb, stream, nread, data);
+  }
+  if (bytes) {
+    moonbit_uv_buffer_pool_release(&loop_data->read_pool, bytes);
+  }
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_read_start_pooled(
+  uv_stream_t *stream,
+  moonbit_uv_read_bytes_cb_t *read_cb
+) {
+  moonbit_uv_tracef("stream = %p\n", (void *)stream);
+  if (moonbit_uv_loop_data(stream->loop) == NULL) {
+    moonbit_decref(read_cb);
+    moonbit_decref(stream);
+    return UV_ENOMEM;
+  }
+  moonbit_uv_stream_data_t *data = moonbit_uv_stream_data_make();
+  data->read_bytes_cb = read_cb;
+  moonbit_uv_stream_set_data(stream, data);
+  int32_t status = uv_read_start(
+    stream, moonbit_uv_read_start_pooled_alloc_cb,
+    moonbit_uv_read_start_pooled_read_cb
+  );
+  moonbit_decref(stream);
+  return status;
+}
+
+static inline void
+moonbit_uv_read_start_shared_alloc_cb(
+  uv_handle_t *handle,
+  size_t suggested_size,
+  uv_buf_t *buf
+) {
+  moonbit_uv_ignore(suggested_size);
+  moonbit_uv_loop_data_t *loop_data = handle->loop->data;
+  // libuv calls `read_cb` right after `alloc_cb`, so the scratch buffer is
+  // never handed out twice. Guard against it anyway: an empty buffer makes
+  // libuv report `UV_ENOBUFS` instead of overwriting data.
+  if (loop_data->read_scratch_in_use) {
+    buf->base = NULL;
+    buf->len = 0;
+    return;
+  }
+  loop_data->read_scratch_in_use = true;
+  buf->base = loop_data->read_scratch;
+  buf->len = MOONBIT_UV_LOOP_READ_SCRATCH_SIZE;
+}
+
+static inline void
+moonbit_uv_read_start_shared_read_cb(
+  uv_stream_t *stream,
+  ssize_t nread,
+  const uv_buf_t *buf
+) {
+  moonbit_uv_tracef("stream = %p\n", (void *)stream);
+  moonbit_uv_stream_stats_record_read(stream, nread);
+  moonbit_uv_stream_data_t *stream_data = stream->data;
+  moonbit_uv_loop_data_t *loop_data = stream->loop->data;
+  moonbit_uv_read_bytes_cb_t *read_cb = stream_data->read_bytes_cb;
+  if (buf->base == loop_data->read_scratch) {
+    loop_data->read_scratch_in_use = false;
+  }
+  if (nread == 0) {
+    return;
+  }
+  moonbit_bytes_t data = NULL;
+  if (nread > 0) {
+    data = moonbit_make_bytes(nread, 0);
+    memcpy(data, buf->base, nread);
+  }
+  moonbit_incref(read_cb);
+  moonbit_incref(stream);
+  read_cb->code(read_cb, stream, nread, data);
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_read_start_shared(
+  uv_stream_t *stream,
+  moonbit_uv_read_bytes_cb_t *read_cb
+) {
+  moonbit_uv_tracef("stream = %p\n", (void *)stream);
+  moonbit_uv_loop_data_t *loop_data = moonbit_uv_loop_data(stream->loop);
+  if (loop_data && loop_data->read_scratch == NULL) {
+    loop_data->read_scratch = malloc(MOONBIT_UV_LOOP_READ_SCRATCH_SIZE);
+  }
+  if (loop_data == NULL || loop_data->read_scratch == NULL) {
+    moonbit_decref(read_cb);
+    moonbit_decref(stream);
+    return UV_ENOMEM;
+  }
+  moonbit_uv_stream_data_t *data = moonbit_uv_stream_data_make();
+  data->read_bytes_cb = read_cb;
+  moonbit_uv_stream_set_data(stream, data);
+  int32_t status = uv_read_start(
+    stream, moonbit_uv_read_start_shared_alloc_cb,
+    moonbit_uv_read_start_shared_read_cb
+  );
+  moonbit_decref(stream);
+  return status;
+}
+
+static inline void
+moonbit_uv_read_start_framed_alloc_cb(
+  uv_handle_t *handle,
+  size_t suggested_size,
+  uv_buf_t *buf
+) {
+  moonbit_uv_ignore(suggested_size);
+  moonbit_uv_stream_data_t *stream_data = handle->data;
+  moonbit_uv_framer_reserve(stream_data->framer, buf);
+}
+
+static inline void
+moonbit_uv_read_start_framed_read_cb(
+  uv_stream_t *stream,
+  ssize_t nread,
+  const uv_buf_t *buf
+) {
+  moonbit_uv_ignore(buf);
+  moonbit_uv_tracef("stream = %p\n", (void *)stream);
+  moonbit_uv_stream_stats_record_read(stream, nread);
+  moonbit_uv_stream_data_t *stream_data = stream->data;
+  moonbit_uv_read_frames_cb_t *read_cb = stream_data->read_frames_cb;
+  moonbit_uv_framer_t *framer = stream_data->framer;
+  if (nread == 0) {
+    return;
+  }
+  int32_t status = 0;
+  size_t count = 0;
+  size_t total = 0;
+  if (nread > 0) {
+    framer->end += nread;
+    count = moonbit_uv_framer_collect(framer, &total, &status);
+    if (count == 0 && status == 0) {
+      return;
+    }
+  } else {
+    status = nread;
+  }
+  // All frames of this read are copied into one `Bytes`, and their lengths
+  // into one array, so that MoonBit sees a single allocation per read event.
+  moonbit_bytes_t frames = moonbit_make_bytes(total, 0);
+  int32_t *frame_lengths = moonbit_make_int32_array(count, 0);
+  size_t position = 0;
+  for (size_t i = 0; i < count; i++) {
+    size_t offset = framer->frames[2 * i];
+    size_t length = framer->frames[2 * i + 1];
+    memcpy((char *)frames + position, framer->data + offset, length);
+    frame_lengths[i] = length;
+    position += length;
+  }
+  moonbit_uv_framer_compact(framer);
+  if (status < 0 && nread > 0) {
+    // The stream can not be framed any further.
+    uv_read_stop(stream);
+  }
+  moonbit_incref(read_cb);
+  moonbit_incref(stream);
+  read_cb->code(read_cb, stream, status, frames, frame_lengths);
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_read_start_framed(
+  uv_stream_t *stream,
+  int32_t framing,
+  uint8_t delimiter,
+  int32_t max_frame_length,
+  moonbit_uv_read_frames_cb_t *read_cb
+) {
+  moonbit_uv_tracef("stream = %p\n", (void *)stream);
+  moonbit_uv_framer_t *framer =
+    moonbit_uv_framer_make(framing, delimiter, max_frame_length);
+  if (framer == NULL) {
+    moonbit_decref(read_cb);
+    moonbit_decref(stream);
+    return UV_ENOMEM;
+  }
+  moonbit_uv_stream_data_t *data = moonbit_uv_stream_data_make();
+  data->read_frames_cb = read_cb;
+  data->framer = framer;
+  moonbit_uv_stream_set_data(stream, data);
+  int32_t status = uv_read_start(
+    stream, moonbit_uv_read_start_framed_alloc_cb,
+    moonbit_uv_read_start_framed_read_cb
+  );
+  moonbit_decref(stream);
+  return status;
+}
+
+// Size of the buffers used to move data from the source to the destination
+// of a relay. Buffers are allocated with the write request that sends them.
+#define MOONBIT_UV_RELAY_CHUNK_SIZE 65536
+
+typedef struct moonbit_uv_relay_cb {
+  int32_t (*code)(
+    struct moonbit_uv_relay_cb *,
+    uv_stream_t *source,
+    int32_t status,
+    uint64_t bytes
+  );
+} moonbit_uv_relay_cb_t;
+
+typedef struct moonbit_uv_relay_chunk_s {
+  uv_write_t req;
+  moonbit_uv_relay_t *relay;
+  struct moonbit_uv_relay_chunk_s *next;
+  size_t length;
+  char data[MOONBIT_UV_RELAY_CHUNK_SIZE];
+} moonbit_uv_relay_chunk_t;
+
+// State of `moonbit_uv_pipe_to`, owned by the stream data of the source and
+// by each write request in flight. Holds the source, so that writes
+// completing after the source stopped reading can still resume or end it.
+struct moonbit_uv_relay_s {
+  uv_stream_t *source;
+  uv_stream_t *dest;
+  moonbit_uv_relay_cb_t *cb;
+  moonbit_uv_relay_chunk_t *free_chunks;
+  int32_t free_count;
+  int32_t max_free_count;
+  // Number of write requests in flight.
+  int32_t pending;
+  // Reading is paused while the write queue of `dest` is longer than this.
+  size_t high_watermark;
+  uint64_t bytes;
+  // `UV_EOF` once the source ended, or the first error.
+  int32_t status;
+  bool finished;
+  // Set once the relay no longer owns the source: after completion, or when
+  // reading was stopped or the source closed.
+  bool detached;
+  bool paused;
+};
+
+static inline void
+moonbit_uv_relay_finalize(void *object) {
+  moonbit_uv_relay_t *relay = object;
+  moonbit_uv_tracef("relay = %p\n", (void *)relay);
+  while (relay->free_chunks) {
+    moonbit_uv_relay_chunk_t *chunk = relay->free_chunks;
+    relay->free_chunks = chunk->next;
+    free(chunk);
+  }
+  if (relay->cb) {
+    moonbit_decref(relay->cb);
+  }
+  moonbit_decref(relay->source);
+  moonbit_decref(relay->dest);
+}
+
+static inline void
+moonbit_uv_relay_detach(moonbit_uv_relay_t *relay) {
+  relay->detached = true;
+  moonbit_decref(relay);
+}
+
+static inline void
+moonbit_uv_relay_release_chunk(
+  moonbit_uv_relay_t *relay,
+  moonbit_uv_relay_chunk_t *chunk
+) {
+  if (relay->free_count < relay->max_free_count) {
+    chunk->next = relay->free_chunks;
+    relay->free_chunks = chunk;
+    relay->free_count++;
+  } else {
+    free(chunk);
+  }
+}
+
+static inline void
+moonbit_uv_relay_report(moonbit_uv_relay_t *relay) {
+  if (relay->detached || !relay->finished || relay->pending > 0) {
+    return;
+  }
+  uv_stream_t *source = relay->source;
+  moonbit_uv_relay_cb_t *cb = relay->cb;
+  relay->cb = NULL;
+  moonbit_incref(relay);
+  moonbit_incref(source);
+  // Releases the stream data of the source, which detaches the relay.
+  moonbit_uv_stream_set_data(source, NULL);
+  cb->code(cb, source, relay->status, relay->bytes);
+  moonbit_decref(relay);
+}
+
+static inline void
+moonbit_uv_relay_finish(moonbit_uv_relay_t *relay, int32_t status) {
+  if (relay->detached) {
+    return;
+  }
+  if (!relay->finished) {
+    relay->finished = true;
+    relay->status = status;
+    uv_read_stop(relay->source);
+  }
+  moonbit_uv_relay_report(relay);
+}
+
+static inline void
+moonbit_uv_relay_alloc_cb(
+  uv_handle_t *handle,
+  size_t suggested_size,
+  uv_buf_t *buf
+) {
+  moonbit_uv_ignore(suggested_size);
+  moonbit_uv_stream_data_t *stream_data = handle->data;
+  moonbit_uv_relay_t *relay = stream_data->relay;
+  moonbit_uv_relay_chunk_t *chunk = relay->free_chunks;
+  if (chunk) {
+    relay->free_chunks = chunk->next;
+    relay->free_count--;
+  } else {
+    chunk = malloc(sizeof(moonbit_uv_relay_chunk_t));
+  }
+  if (chunk == NULL) {
+    // libuv reports `UV_ENOBUFS` to the read callback.
+    *buf = uv_buf_init(NULL, 0);
+    return;
+  }
+  *buf = uv_buf_init(chunk->data, MOONBIT_UV_RELAY_CHUNK_SIZE);
+}
+
+static inline void
+moonbit_uv_relay_read_cb(
+  uv_stream_t *source,
+  ssize_t nread,
+  const uv_buf_t *buf
+);
+
+static inline void
+moonbit_uv_relay_write_cb(uv_write_t *req, int status) {
+  moonbit_uv_relay_chunk_t *chunk =
+    containerof(req, moonbit_uv_relay_chunk_t, req);
+  moonbit_uv_relay_t *relay = chunk->relay;
+  relay->pending--;
+  if (status == 0) {
+    relay->bytes += chunk->length;
+  }
+  moonbit_uv_relay_release_chunk(relay, chunk);
+  if (status < 0) {
+    moonbit_uv_relay_finish(relay, status);
+  } else if (relay->finished) {
+    moonbit_uv_relay_report(relay);
+  } else if (!relay->detached && relay->paused &&
+             relay->dest->write_queue_size <= relay->high_watermark / 2) {
+    relay->paused = false;
+    status = uv_read_start(
+      relay->source, moonbit_uv_relay_alloc_cb, moonbit_uv_relay_read_cb
+    );
+    if (status < 0) {
+      moonbit_uv_relay_finish(relay, status);
+    }
+  }
+  moonbit_decref(relay);
+}
+
+static inline void
+moonbit_uv_relay_read_cb(
+  uv_stream_t *source,
+  ssize_t nread,
+  const uv_buf_t *buf
+) {
+  moonbit_uv_stream_stats_record_read(source, nread);
+  moonbit_uv_stream_data_t *stream_data = source->data;
+  moonbit_uv_relay_t *relay = stream_data->relay;
+  moonbit_uv_relay_chunk_t *chunk = NULL;
+  if (buf->base) {
+    chunk = containerof(buf->base, moonbit_uv_relay_chunk_t, data);
+  }
+  if (nread <= 0) {
+    if (chunk) {
+      moonbit_uv_relay_release_chunk(relay, chunk);
+    }
+    if (nread < 0) {
+      moonbit_uv_relay_finish(relay, (int32_t)nread);
+    }
+    return;
+  }
+  uv_buf_t data = uv_buf_init(chunk->data, nread);
+  chunk->relay = relay;
+  chunk->length = nread;
+  moonbit_incref(relay);
+  relay->pending++;
+  int status =
+    uv_write(&chunk->req, relay->dest, &data, 1, moonbit_uv_relay_write_cb);
+  if (status < 0) {
+    relay->pending--;
+    moonbit_uv_relay_release_chunk(relay, chunk);
+    moonbit_decref(relay);
+    moonbit_uv_relay_finish(relay, status);
+    return;
+  }
+  if (relay->dest->write_queue_size > relay->high_watermark) {
+    relay->paused = true;
+    uv_read_stop(source);
+  }
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_pipe_to(
+  uv_stream_t *source,
+  uv_stream_t *dest,
+  int32_t high_watermark,
+  moonbit_uv_relay_cb_t *cb
+) {
+  moonbit_uv_tracef("source = %p\n", (void *)source);
+  moonbit_uv_tracef("dest = %p\n", (void *)dest);
+  moonbit_uv_relay_t *relay = (moonbit_uv_relay_t *)
+    moonbit_make_external_object(
+      moonbit_uv_relay_finalize, sizeof(moonbit_uv_relay_t)
+    );
+  memset(relay, 0, sizeof(moonbit_uv_relay_t));
+  // The relay takes over the references to `source`, `dest` and `cb`.
+  relay->source = source;
+  relay->dest = dest;
+  relay->cb = cb;
+  relay->high_watermark = high_watermark;
+  relay->max_free_count = high_watermark / MOONBIT_UV_RELAY_CHUNK_SIZE + 1;
+  moonbit_uv_stream_data_t *data = moonbit_uv_stream_data_make();
+  data->relay = relay;
+  moonbit_uv_stream_set_data(source, data);
+  int32_t status =
+    uv_read_start(source, moonbit_uv_relay_alloc_cb, moonbit_uv_relay_read_cb);
+  if (status < 0) {
+    moonbit_uv_stream_set_data(source, NULL);
+  }
+  return status;
+}
+
 MOONBIT_FFI_EXPORT
 int32_t
 moonbit_uv_read_stop(uv_stream_t *stream) {
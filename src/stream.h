@@ -17,8 +17,10 @@
 #ifndef MOONBIT_UV_STREAM_H
 #define MOONBIT_UV_STREAM_H
 
+#include "loop.h"
 #include "moonbit.h"
 #include "uv#include#uv.h"
+#include <stdlib.h>
 
 typedef struct moonbit_uv_alloc_cb_s {
   moonbit_bytes_t (*code)(
@@ -52,4 +54,141 @@ typedef struct moonbit_uv_connection_cb {
   );
 } moonbit_uv_connection_cb_t;
 
+// Stream handles that can keep traffic counters are laid out as their libuv
+// handle followed by a pointer to the counters, allocated on first use.
+typedef struct moonbit_uv_tcp_s {
+  uv_tcp_t tcp;
+  moonbit_uv_stream_stats_t *stats;
+} moonbit_uv_tcp_t;
+
+typedef struct moonbit_uv_pipe_s {
+  uv_pipe_t pipe;
+  moonbit_uv_stream_stats_t *stats;
+} moonbit_uv_pipe_t;
+
+static inline moonbit_uv_stream_stats_t **
+moonbit_uv_stream_stats_slot(uv_stream_t *stream) {
+  switch (stream->type) {
+  case UV_TCP:
+    return &((moonbit_uv_tcp_t *)stream)->stats;
+  case UV_NAMED_PIPE:
+    return &((moonbit_uv_pipe_t *)stream)->stats;
+  default:
+    return NULL;
+  }
+}
+
+// Returns the counters of the loop of `stream` if it keeps them, or NULL.
+static inline moonbit_uv_stream_stats_t *
+moonbit_uv_stream_stats_of_loop(uv_stream_t *stream) {
+  moonbit_uv_loop_data_t *loop_data = stream->loop->data;
+  if (loop_data == NULL || !loop_data->stream_stats_enabled) {
+    return NULL;
+  }
+  return &loop_data->stream_stats;
+}
+
+static inline moonbit_uv_stream_stats_t *
+moonbit_uv_stream_stats(uv_stream_t *stream) {
+  moonbit_uv_stream_stats_t **slot = moonbit_uv_stream_stats_slot(stream);
+  if (slot == NULL) {
+    return NULL;
+  }
+  if (*slot == NULL) {
+    *slot = calloc(1, sizeof(moonbit_uv_stream_stats_t));
+  }
+  return *slot;
+}
+
+static inline void
+moonbit_uv_stream_stats_record_read(uv_stream_t *stream, ssize_t nread) {
+  moonbit_uv_stream_stats_t *loop_stats =
+    moonbit_uv_stream_stats_of_loop(stream);
+  if (loop_stats == NULL || nread <= 0) {
+    return;
+  }
+  loop_stats->reads++;
+  loop_stats->bytes_read += nread;
+  moonbit_uv_stream_stats_t *stats = moonbit_uv_stream_stats(stream);
+  if (stats) {
+    stats->reads++;
+    stats->bytes_read += nread;
+  }
+}
+
+// Called after queueing a write, returns the time it was queued at, or 0 if
+// the loop keeps no counters.
+static inline uint64_t
+moonbit_uv_stream_stats_record_queued(uv_stream_t *stream) {
+  moonbit_uv_stream_stats_t *loop_stats =
+    moonbit_uv_stream_stats_of_loop(stream);
+  if (loop_stats == NULL) {
+    return 0;
+  }
+  uint64_t size = stream->write_queue_size;
+  if (size > loop_stats->write_queue_high_water) {
+    loop_stats->write_queue_high_water = size;
+  }
+  moonbit_uv_stream_stats_t *stats = moonbit_uv_stream_stats(stream);
+  if (stats && size > stats->write_queue_high_water) {
+    stats->write_queue_high_water = size;
+  }
+  return uv_hrtime();
+}
+
+static inline void
+moonbit_uv_stream_stats_update_written(
+  moonbit_uv_stream_stats_t *stats,
+  uint64_t bytes,
+  int status,
+  uint64_t latency
+) {
+  if (status < 0) {
+    stats->write_errors++;
+    return;
+  }
+  stats->writes++;
+  stats->bytes_written += bytes;
+  stats->write_latency_total += latency;
+  if (latency > stats->write_latency_max) {
+    stats->write_latency_max = latency;
+  }
+}
+
+static inline void
+moonbit_uv_stream_stats_record_written(
+  uv_stream_t *stream,
+  uint64_t bytes,
+  int status,
+  uint64_t queued_at
+) {
+  moonbit_uv_stream_stats_t *loop_stats =
+    moonbit_uv_stream_stats_of_loop(stream);
+  // Writes queued before the counters were enabled are not accounted for.
+  if (loop_stats == NULL || queued_at == 0) {
+    return;
+  }
+  uint64_t latency = uv_hrtime() - queued_at;
+  moonbit_uv_stream_stats_update_written(loop_stats, bytes, status, latency);
+  moonbit_uv_stream_stats_t *stats = moonbit_uv_stream_stats(stream);
+  if (stats) {
+    moonbit_uv_stream_stats_update_written(stats, bytes, status, latency);
+  }
+}
+
+// Records a write completed synchronously by `uv_try_write()`.
+static inline void
+moonbit_uv_stream_stats_record_try_write(uv_stream_t *stream, int result) {
+  moonbit_uv_stream_stats_t *loop_stats =
+    moonbit_uv_stream_stats_of_loop(stream);
+  if (loop_stats == NULL || result < 0) {
+    return;
+  }
+  moonbit_uv_stream_stats_update_written(loop_stats, result, 0, 0);
+  moonbit_uv_stream_stats_t *stats = moonbit_uv_stream_stats(stream);
+  if (stats) {
+    moonbit_uv_stream_stats_update_written(stats, result, 0, 0);
+  }
+}
+
 #endif // MOONBIT_UV_STREAM_H
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2026 International Digital Economy Academy
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "loop.h"
+#include "moonbit.h"
+#include "stream.h"
+#include "uv#include#uv.h"
+#include "uv.h"
+#include <string.h>
+
+static inline void
+moonbit_uv_stream_stats_copy(
+  const moonbit_uv_stream_stats_t *from,
+  uint64_t *stats
+) {
+  stats[0] = from->bytes_read;
+  stats[1] = from->reads;
+  stats[2] = from->bytes_written;
+  stats[3] = from->writes;
+  stats[4] = from->write_errors;
+  stats[5] = from->write_queue_high_water;
+  stats[6] = from->write_latency_total;
+  stats[7] = from->write_latency_max;
+}
+
+MOONBIT_FFI_EXPORT
+void
+moonbit_uv_loop_enable_stream_stats(uv_loop_t *loop, bool enable) {
+  moonbit_uv_loop_data_t *data = moonbit_uv_loop_data(loop);
+  if (data) {
+    data->stream_stats_enabled = enable;
+  }
+  moonbit_decref(loop);
+}
+
+MOONBIT_FFI_EXPORT
+void
+moonbit_uv_loop_stream_stats(uv_loop_t *loop, uint64_t *stats) {
+  moonbit_uv_loop_data_t *data = loop->data;
+  if (data) {
+    moonbit_uv_stream_stats_copy(&data->stream_stats, stats);
+  }
+  moonbit_decref(loop);
+  moonbit_decref(stats);
+}
+
+MOONBIT_FFI_EXPORT
+void
+moonbit_uv_stream_get_stats(uv_stream_t *stream, uint64_t *stats) {
+  moonbit_uv_stream_stats_t **slot = moonbit_uv_stream_stats_slot(stream);
+  if (slot && *slot) {
+    moonbit_uv_stream_stats_copy(*slot, stats);
+  }
+  moonbit_decref(stream);
+  moonbit_decref(stats);
+}
@@ -19,11 +19,10 @@
 #include "socket.h"
 #include "stream.h"
 #include "uv#include#uv.h"
-#include "uv.h"
+#include <stdlib.h>
+#include <string.h>
 
-typedef struct moonbit_uv_tcp_s {
-  uv_tcp_t tcp;
-} moonbit_uv_tcp_t;
+#include "uv.h"
 
 static inline void
 moonbit_uv_tcp_finalize(void *object) {
@@ -39,6 +38,7 @@ moonbit_uv_tcp_finalize(void *object) {
     moonbit_decref(tcp->tcp.loop);
     tcp->tcp.loop = NULL;
   }
+  free(tcp->stats);
 }
 
 MOONBIT_FFI_EXPORT
@@ -190,3 +190,155 @@ moonbit_uv_tcp_simultaneous_accepts(moonbit_uv_tcp_t *tcp, bool enable) {
   moonbit_decref(tcp);
   return result;
 }
+
+typedef struct moonbit_uv_listen_batch_cb {
+  int32_t (*code)(
+    struct moonbit_uv_listen_batch_cb *,
+    moonbit_uv_tcp_t *server,
+    int32_t status,
+    moonbit_uv_tcp_t **clients
+  );
+} moonbit_uv_listen_batch_cb_t;
+
+// Listening state of a server started with `moonbit_uv_tcp_listen_batch`,
+// stored in the `data` field of the server in place of the connection
+// callback. Connections are accepted in C as soon as libuv reports them and
+// are handed to MoonBit together, either from a check handle at the end of
+// the loop iteration or as soon as `capacity` connections are pending.
+typedef struct moonbit_uv_listen_batch_s {
+  moonbit_uv_listen_batch_cb_t *cb;
+  // Not owned: the server owns the batch through its `data` field.
+  moonbit_uv_tcp_t *server;
+  // Allocated separately, so that it can outlive the batch until closed.
+  uv_check_t *flush;
+  moonbit_uv_tcp_t **clients;
+  int32_t count;
+  int32_t capacity;
+} moonbit_uv_listen_batch_t;
+
+static inline void
+moonbit_uv_listen_batch_check_close_cb(uv_handle_t *handle) {
+  free(handle);
+}
+
+static inline void
+moonbit_uv_listen_batch_discard_cb(uv_handle_t *handle) {
+  moonbit_decref(handle);
+}
+
+static inline void
+moonbit_uv_listen_batch_discard(moonbit_uv_tcp_t *client) {
+  // The reference held by the open handle is released by the close callback.
+  uv_close((uv_handle_t *)&client->tcp, moonbit_uv_listen_batch_discard_cb);
+}
+
+static inline void
+moonbit_uv_listen_batch_finalize(void *object) {
+  moonbit_uv_listen_batch_t *batch = (moonbit_uv_listen_batch_t *)object;
+  moonbit_uv_tracef("batch = %p\n", (void *)batch);
+  for (int32_t i = 0; i < batch->count; i++) {
+    moonbit_uv_listen_batch_discard(batch->clients[i]);
+    moonbit_decref(batch->clients[i]);
+  }
+  free(batch->clients);
+  if (batch->flush) {
+    uv_close(
+      (uv_handle_t *)batch->flush, moonbit_uv_listen_batch_check_close_cb
+    );
+  }
+  moonbit_decref(batch->cb);
+}
+
+static inline void
+moonbit_uv_listen_batch_flush(
+  moonbit_uv_listen_batch_t *batch,
+  int32_t status
+) {
+  int32_t count = batch->count;
+  moonbit_uv_tcp_t **clients =
+    (moonbit_uv_tcp_t **)moonbit_make_ref_array(count, NULL);
+  if (count > 0) {
+    memcpy(clients, batch->clients, count * sizeof(moonbit_uv_tcp_t *));
+  }
+  batch->count = 0;
+  uv_check_stop(batch->flush);
+  moonbit_uv_listen_batch_cb_t *cb = batch->cb;
+  moonbit_incref(cb);
+  moonbit_incref(batch->server);
+  // The batch may be released by the callback, e.g. if it closes the server.
+  cb->code(cb, batch->server, status, clients);
+}
+
+static inline void
+moonbit_uv_listen_batch_check_cb(uv_check_t *check) {
+  moonbit_uv_listen_batch_flush(check->data, 0);
+}
+
+static inline void
+moonbit_uv_listen_batch_connection_cb(uv_stream_t *server, int status) {
+  moonbit_uv_listen_batch_t *batch = server->data;
+  if (status == 0) {
+    moonbit_uv_tcp_t *client = moonbit_uv_tcp_make();
+    moonbit_incref(server->loop);
+    // Initializing an `AF_UNSPEC` handle does not create a socket and cannot
+    // fail, so there is nothing to undo here.
+    uv_tcp_init(server->loop, &client->tcp);
+    // Reference held by the open handle, as with `Tcp::new()`.
+    moonbit_incref(client);
+    status = uv_accept(server, (uv_stream_t *)&client->tcp);
+    if (status < 0) {
+      moonbit_uv_listen_batch_discard(client);
+      moonbit_decref(client);
+    } else {
+      batch->clients[batch->count++] = client;
+      if (batch->count < batch->capacity) {
+        uv_check_start(batch->flush, moonbit_uv_listen_batch_check_cb);
+        return;
+      }
+    }
+  }
+  // Errors are delivered along with the connections accepted before them.
+  // `EMFILE` never stops the server: libuv keeps a spare file descriptor per
+  // loop to accept and drop the pending connections in that case.
+  moonbit_uv_listen_batch_flush(batch, status);
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_tcp_listen_batch(
+  moonbit_uv_tcp_t *server,
+  int32_t backlog,
+  int32_t max_batch,
+  moonbit_uv_listen_batch_cb_t *cb
+) {
+  moonbit_uv_listen_batch_t *batch =
+    (moonbit_uv_listen_batch_t *)moonbit_make_external_object(
+      moonbit_uv_listen_batch_finalize, sizeof(moonbit_uv_listen_batch_t)
+    );
+  memset(batch, 0, sizeof(moonbit_uv_listen_batch_t));
+  batch->cb = cb;
+  batch->server = server;
+  batch->capacity = max_batch;
+  batch->clients =
+    (moonbit_uv_tcp_t **)malloc(max_batch * sizeof(moonbit_uv_tcp_t *));
+  uv_check_t *flush = (uv_check_t *)malloc(sizeof(uv_check_t));
+  if (batch->clients == NULL || flush == NULL) {
+    free(flush);
+    moonbit_decref(batch);
+    moonbit_decref(server);
+    return UV_ENOMEM;
+  }
+  uv_check_init(server->tcp.loop, flush);
+  flush->data = batch;
+  batch->flush = flush;
+  moonbit_uv_handle_set_data((uv_handle_t *)&server->tcp, batch);
+  int result = uv_listen(
+    (uv_stream_t *)&server->tcp, backlog, moonbit_uv_listen_batch_connection_cb
+  );
+  if (result < 0) {
+    server->tcp.data = NULL;
+    moonbit_decref(batch);
+  }
+  moonbit_decref(server);
+  return result;
+}
@@ -15,6 +15,14 @@
  */
 
 #include <stdlib.h>
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 
 #include "moonbit.h"
 #include "uv#include#uv.h"
@@ -22,8 +30,23 @@
 
 #include "stream.h"
 
+#ifdef __linux__
+// Not defined by older C libraries.
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
+
 typedef struct moonbit_uv_udp_s {
   uv_udp_t udp;
+  // Whether `UDP_GRO` was enabled by `moonbit_uv_udp_recv_start_batch`.
+  bool gro;
 } moonbit_uv_udp_t;
 
 static inline void
@@ -134,13 +157,53 @@ moonbit_uv_udp_send_data_make(void) {
   return send_data;
 }
 
+MOONBIT_FFI_EXPORT
+moonbit_uv_udp_send_t *
+moonbit_uv_udp_send_acquire(moonbit_uv_udp_t *udp) {
+  moonbit_uv_loop_data_t *data = moonbit_uv_loop_data(udp->udp.loop);
+  moonbit_uv_udp_send_t *send =
+    data ? moonbit_uv_req_pool_acquire(&data->udp_send_pool) : NULL;
+  return send ? send : moonbit_uv_udp_send_make();
+}
+
+// Resets `send`, whose callback has returned, and gives it back to the pool
+// of `loop` if nothing else references it. Its data object is kept for the
+// next send when it is not referenced either.
+static inline void
+moonbit_uv_udp_send_recycle(moonbit_uv_udp_send_t *send, uv_loop_t *loop) {
+  if (loop->data) {
+    moonbit_uv_req_pool_t *pool =
+      &((moonbit_uv_loop_data_t *)loop->data)->udp_send_pool;
+    if (moonbit_uv_req_pool_recyclable(pool, send)) {
+      moonbit_uv_udp_send_data_t *data = send->req.data;
+      if (data && Moonbit_object_header(data)->rc == 1 && data->cb == NULL) {
+        if (data->bufs) {
+          moonbit_decref(data->bufs);
+        }
+        memset(data, 0, sizeof(moonbit_uv_udp_send_data_t));
+      } else if (data) {
+        moonbit_decref(data);
+        data = NULL;
+      }
+      memset(&send->req, 0, sizeof(uv_udp_send_t));
+      send->req.data = data;
+      moonbit_uv_req_pool_release(pool, send);
+      return;
+    }
+  }
+  moonbit_decref(send);
+}
+
 static inline void
 moonbit_uv_udp_send_cb(uv_udp_send_t *req, int status) {
   moonbit_uv_udp_send_data_t *data = req->data;
   moonbit_uv_udp_send_cb_t *cb = data->cb;
   data->cb = NULL;
+  uv_loop_t *loop = req->handle->loop;
   moonbit_uv_udp_send_t *send = containerof(req, moonbit_uv_udp_send_t, req);
+  moonbit_incref(send);
   cb->code(cb, send, status);
+  moonbit_uv_udp_send_recycle(send, loop);
 }
 
 static inline void
@@ -171,10 +234,13 @@ moonbit_uv_udp_send(
     bufs_data[i] =
       uv_buf_init((char *)bufs[i] + bufs_offset[i], bufs_length[i]);
   }
-  moonbit_uv_udp_send_data_t *data = moonbit_uv_udp_send_data_make();
+  // A recycled request comes with the data object of its previous send.
+  if (req->req.data == NULL) {
+    moonbit_uv_udp_send_set_data(req, moonbit_uv_udp_send_data_make());
+  }
+  moonbit_uv_udp_send_data_t *data = req->req.data;
   data->bufs = bufs;
   data->cb = cb;
-  moonbit_uv_udp_send_set_data(req, data);
   int result = uv_udp_send(
     &req->req, &udp->udp, bufs_data, bufs_size, addr, moonbit_uv_udp_send_cb
   );
@@ -194,15 +260,22 @@ typedef struct moonbit_uv_udp_recv_cb {
     moonbit_bytes_t buf,
     int32_t buf_offset,
     int32_t buf_length,
-    const struct sockaddr *addr,
+    struct sockaddr *addr,
     unsigned flags
   );
 } moonbit_uv_udp_recv_cb_t;
 
+// Number of sender addresses cached per receiving handle.
+#define MOONBIT_UV_UDP_PEER_CACHE_SIZE 4
+
 typedef struct moonbit_uv_udp_data_s {
   moonbit_bytes_t bytes;
   moonbit_uv_alloc_cb_t *alloc_cb;
   moonbit_uv_udp_recv_cb_t *read_cb;
+  // Sender addresses of recent datagrams, handed to `read_cb` again instead
+  // of being allocated for each datagram.
+  struct sockaddr *peers[MOONBIT_UV_UDP_PEER_CACHE_SIZE];
+  int32_t next_peer;
 } moonbit_uv_udp_data_t;
 
 static inline void
@@ -218,6 +291,11 @@ moonbit_uv_udp_data_finalize(void *object) {
   if (data->alloc_cb) {
     moonbit_decref(data->alloc_cb);
   }
+  for (int32_t i = 0; i < MOONBIT_UV_UDP_PEER_CACHE_SIZE; i++) {
+    if (data->peers[i]) {
+      moonbit_decref(data->peers[i]);
+    }
+  }
 }
 
 static inline moonbit_uv_udp_data_t *
@@ -233,6 +311,20 @@ moonbit_uv_udp_data_make(void) {
 
 static inline void
 moonbit_uv_udp_set_data(uv_udp_t *udp, moonbit_uv_udp_data_t *data) {
+#ifdef __linux__
+  // The receive state is replaced or cleared: turn `UDP_GRO` off, so that
+  // later receives on the handle are not coalesced. This cannot wait for the
+  // finalizer of the batch, which may run after a new receive has started.
+  moonbit_uv_udp_t *handle = (moonbit_uv_udp_t *)udp;
+  if (handle->gro) {
+    uv_os_fd_t fd;
+    int off = 0;
+    if (uv_fileno((uv_handle_t *)udp, &fd) == 0) {
+      setsockopt(fd, SOL_UDP, UDP_GRO, &off, sizeof(off));
+    }
+    handle->gro = false;
+  }
+#endif
   if (udp->data) {
     moonbit_decref(udp->data);
   }
@@ -261,6 +353,67 @@ moonbit_uv_udp_recv_start_alloc_cb(
   udp_data->bytes = buf_base;
 }
 
+static inline socklen_t
+moonbit_uv_udp_addr_length(const struct sockaddr *addr) {
+  switch (addr->sa_family) {
+  case AF_INET:
+    return sizeof(struct sockaddr_in);
+  case AF_INET6:
+    return sizeof(struct sockaddr_in6);
+  default:
+    return sizeof(struct sockaddr_storage);
+  }
+}
+
+// Returns a `Sockaddr` holding `addr`, taken from the peer cache of
+// `udp_data` when possible. A cached address is handed out again as is if it
+// holds `addr`, or overwritten if no one else holds a reference to it;
+// otherwise the oldest entry is replaced by a new allocation.
+static inline struct sockaddr *
+moonbit_uv_udp_peer(
+  moonbit_uv_udp_data_t *udp_data,
+  const struct sockaddr *addr
+) {
+  socklen_t addrlen = moonbit_uv_udp_addr_length(addr);
+  int32_t reusable = -1;
+  for (int32_t i = 0; i < MOONBIT_UV_UDP_PEER_CACHE_SIZE; i++) {
+    struct sockaddr *peer = udp_data->peers[i];
+    if (peer == NULL) {
+      if (reusable < 0) {
+        reusable = i;
+      }
+      continue;
+    }
+    if (peer->sa_family == addr->sa_family &&
+        memcmp(peer, addr, addrlen) == 0) {
+      moonbit_incref(peer);
+      return peer;
+    }
+    if (reusable < 0 && Moonbit_object_header(peer)->rc == 1) {
+      reusable = i;
+    }
+  }
+  if (reusable < 0) {
+    reusable = udp_data->next_peer;
+    udp_data->next_peer =
+      (udp_data->next_peer + 1) % MOONBIT_UV_UDP_PEER_CACHE_SIZE;
+    moonbit_decref(udp_data->peers[reusable]);
+    udp_data->peers[reusable] = NULL;
+  }
+  struct sockaddr *peer = udp_data->peers[reusable];
+  if (peer == NULL) {
+    peer = (struct sockaddr *)moonbit_make_bytes(
+      sizeof(struct sockaddr_storage), 0
+    );
+    udp_data->peers[reusable] = peer;
+  } else {
+    memset(peer, 0, sizeof(struct sockaddr_storage));
+  }
+  memcpy(peer, addr, addrlen);
+  moonbit_incref(peer);
+  return peer;
+}
+
 static inline void
 moonbit_uv_udp_recv_start_cb(
   uv_udp_t *udp,
@@ -273,26 +426,30 @@ moonbit_uv_udp_recv_start_cb(
   moonbit_uv_udp_data_t *udp_data = udp->data;
   moonbit_uv_udp_recv_cb_t *read_cb = udp_data->read_cb;
   moonbit_bytes_t buf_base = udp_data->bytes;
-  udp_data->bytes = NULL;
-  int32_t buf_offset = buf->base - (char *)buf_base;
+  if (flags & UV_UDP_MMSG_CHUNK) {
+    // The chunks of a `recvmmsg()` call share the buffer, which is released
+    // by the final `UV_UDP_MMSG_FREE` callback.
+    moonbit_incref(buf_base);
+  } else {
+    udp_data->bytes = NULL;
+  }
+  if (nread == 0 && addr == NULL) {
+    // Nothing was read, or libuv is done with the buffer of a `recvmmsg()`
+    // call: there is no datagram to report.
+    if (buf_base) {
+      moonbit_decref(buf_base);
+    }
+    return;
+  }
+  int32_t buf_offset = buf_base ? buf->base - (char *)buf_base : 0;
   int32_t buf_length = buf->len;
   moonbit_incref(read_cb);
   moonbit_incref(udp);
   moonbit_uv_tracef("udp->rc (before) = %d\n", Moonbit_object_header(udp)->rc);
-  void *addr_copied;
-  if (addr->sa_family == AF_INET) {
-    moonbit_uv_trace("addr->sa_family = AF_INET\n");
-    addr_copied = moonbit_make_bytes(sizeof(struct sockaddr_in), 0);
-  } else if (addr->sa_family == AF_INET6) {
-    moonbit_uv_trace("addr->sa_family = AF_INET6\n");
-    addr_copied = moonbit_make_bytes(sizeof(struct sockaddr_in6), 0);
-  } else {
-    moonbit_uv_tracef("addr->sa_family = %d\n", addr->sa_family);
-    addr_copied = moonbit_make_bytes(sizeof(struct sockaddr), 0);
-  }
-  memcpy(addr_copied, addr, sizeof(struct sockaddr));
+  // `addr` is NULL on errors.
+  struct sockaddr *peer = addr ? moonbit_uv_udp_peer(udp_data, addr) : NULL;
   read_cb->code(
-    read_cb, udp, nread, buf_base, buf_offset, buf_length, addr_copied, flags
+    read_cb, udp, nread, buf_base, buf_offset, buf_length, peer, flags
   );
   moonbit_uv_tracef("udp->rc (after ) = %d\n", Moonbit_object_header(udp)->rc);
 }
@@ -330,6 +487,395 @@ moonbit_uv_udp_recv_stop(uv_udp_t *udp) {
   return status;
 }
 
+typedef struct moonbit_uv_udp_recv_batch_cb {
+  int32_t (*code)(
+    struct moonbit_uv_udp_recv_batch_cb *,
+    moonbit_uv_udp_t *udp,
+    int32_t status,
+    int32_t count,
+    moonbit_bytes_t data,
+    int32_t *records,
+    moonbit_bytes_t addrs
+  );
+} moonbit_uv_udp_recv_batch_cb_t;
+
+// Size of the buffer reserved per datagram. With `UV_UDP_RECVMMSG`, libuv
+// splits the receive buffer into chunks of this size, one per message.
+#define MOONBIT_UV_UDP_DGRAM_MAXSIZE (64 * 1024)
+
+// Number of `int32_t` fields per datagram in `records`: offset in `data`,
+// length, flags and segment size.
+#define MOONBIT_UV_UDP_RECORD_SIZE 4
+
+// Receiving state of a handle started with `moonbit_uv_udp_recv_start_batch`,
+// stored in the `data` field of the handle in place of
+// `moonbit_uv_udp_data_t`. Datagrams are received into `data` and described
+// in `records` and `addrs`, and handed to MoonBit together once per
+// `recvmmsg()` call, or once per loop iteration without `UV_UDP_RECVMMSG`.
+//
+// With `gro` set, libuv cannot report the segment size of coalesced
+// datagrams, so libuv does not receive at all: `poll` watches a duplicate of
+// the socket instead, and the socket is drained with `recvmsg()`, which
+// returns the segment size of every read along with it.
+typedef struct moonbit_uv_udp_recv_batch_s {
+  moonbit_uv_udp_recv_batch_cb_t *cb;
+  // Not owned: the handle owns the batch through its `data` field.
+  moonbit_uv_udp_t *udp;
+  // Allocated separately, so that they can outlive the batch until closed.
+  uv_check_t *flush;
+  uv_poll_t *poll;
+  // The buffers below are reused from batch to batch, unless the callback
+  // keeps a reference to them, in which case new ones are allocated.
+  moonbit_bytes_t data;
+  int32_t *records;
+  moonbit_bytes_t addrs;
+  int32_t count;
+  int32_t capacity;
+  // Size of `data`.
+  int32_t size;
+  // Number of bytes of `data` in use.
+  int32_t used;
+} moonbit_uv_udp_recv_batch_t;
+
+static inline void
+moonbit_uv_udp_recv_batch_check_close_cb(uv_handle_t *handle) {
+  free(handle);
+}
+
+#ifdef __linux__
+static inline void
+moonbit_uv_udp_recv_batch_poll_close_cb(uv_handle_t *handle) {
+  uv_os_fd_t fd;
+  if (uv_fileno(handle, &fd) == 0) {
+    close(fd);
+  }
+  free(handle);
+}
+#endif
+
+static inline void
+moonbit_uv_udp_recv_batch_finalize(void *object) {
+  moonbit_uv_udp_recv_batch_t *batch = object;
+  moonbit_uv_tracef("batch = %p\n", (void *)batch);
+  if (batch->data) {
+    moonbit_decref(batch->data);
+  }
+  if (batch->records) {
+    moonbit_decref(batch->records);
+  }
+  if (batch->addrs) {
+    moonbit_decref(batch->addrs);
+  }
+  if (batch->flush) {
+    uv_close(
+      (uv_handle_t *)batch->flush, moonbit_uv_udp_recv_batch_check_close_cb
+    );
+  }
+#ifdef __linux__
+  if (batch->poll) {
+    uv_close(
+      (uv_handle_t *)batch->poll, moonbit_uv_udp_recv_batch_poll_close_cb
+    );
+  }
+#endif
+  moonbit_decref(batch->cb);
+}
+
+static inline void
+moonbit_uv_udp_recv_batch_release(void **buffer) {
+  // Only the batch holds the buffer, unless the callback kept it.
+  if (*buffer && Moonbit_object_header(*buffer)->rc > 1) {
+    moonbit_decref(*buffer);
+    *buffer = NULL;
+  }
+}
+
+static inline void
+moonbit_uv_udp_recv_batch_flush(
+  moonbit_uv_udp_recv_batch_t *batch,
+  int32_t status
+) {
+  uv_check_stop(batch->flush);
+  int32_t count = batch->count;
+  batch->count = 0;
+  batch->used = 0;
+  if (count == 0 && status == 0) {
+    return;
+  }
+  moonbit_uv_udp_recv_batch_cb_t *cb = batch->cb;
+  moonbit_incref(cb);
+  moonbit_incref(batch->udp);
+  moonbit_incref(batch->data);
+  moonbit_incref(batch->records);
+  moonbit_incref(batch->addrs);
+  // The batch may be released by the callback, e.g. if it stops receiving.
+  moonbit_incref(batch);
+  cb->code(
+    cb, batch->udp, status, count, batch->data, batch->records, batch->addrs
+  );
+  moonbit_uv_udp_recv_batch_release((void **)&batch->data);
+  moonbit_uv_udp_recv_batch_release((void **)&batch->records);
+  moonbit_uv_udp_recv_batch_release((void **)&batch->addrs);
+  moonbit_decref(batch);
+}
+
+static inline void
+moonbit_uv_udp_recv_batch_check_cb(uv_check_t *check) {
+  moonbit_uv_udp_recv_batch_flush(check->data, 0);
+}
+
+static inline void
+moonbit_uv_udp_recv_batch_record(
+  moonbit_uv_udp_recv_batch_t *batch,
+  int32_t offset,
+  int32_t length,
+  unsigned flags,
+  int32_t segment_size,
+  const struct sockaddr *addr
+) {
+  int32_t *record = batch->records + batch->count * MOONBIT_UV_UDP_RECORD_SIZE;
+  record[0] = offset;
+  record[1] = length;
+  record[2] = flags;
+  record[3] = segment_size;
+  memcpy(
+    batch->addrs + batch->count * sizeof(struct sockaddr_storage), addr,
+    moonbit_uv_udp_addr_length(addr)
+  );
+  batch->count++;
+}
+
+// Allocates the buffers that the previous callback kept, or that were never
+// allocated.
+static inline void
+moonbit_uv_udp_recv_batch_prepare(moonbit_uv_udp_recv_batch_t *batch) {
+  if (batch->data == NULL) {
+    batch->data = moonbit_make_bytes(batch->size, 0);
+  }
+  if (batch->records == NULL) {
+    batch->records = moonbit_make_int32_array(
+      batch->capacity * MOONBIT_UV_UDP_RECORD_SIZE, 0
+    );
+  }
+  if (batch->addrs == NULL) {
+    batch->addrs =
+      moonbit_make_bytes(batch->capacity * sizeof(struct sockaddr_storage), 0);
+  }
+}
+
+#ifdef __linux__
+// Receives datagrams from the socket of a handle started with `gro` set,
+// with `recvmsg()` until it is drained or the batch is full, and delivers
+// them. Each read may hold several datagrams coalesced by the kernel, whose
+// size comes with it.
+static inline void
+moonbit_uv_udp_recv_batch_poll_cb(uv_poll_t *poll, int status, int events) {
+  moonbit_uv_ignore(events);
+  moonbit_uv_udp_recv_batch_t *batch = poll->data;
+  if (status < 0) {
+    moonbit_uv_udp_recv_batch_flush(batch, status);
+    return;
+  }
+  uv_os_fd_t fd;
+  status = uv_fileno((uv_handle_t *)poll, &fd);
+  moonbit_uv_udp_recv_batch_prepare(batch);
+  while (status == 0 && batch->count < batch->capacity) {
+    struct sockaddr_storage addr;
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = {
+      .iov_base = (char *)batch->data + batch->used,
+      .iov_len = MOONBIT_UV_UDP_DGRAM_MAXSIZE,
+    };
+    struct msghdr msg = {
+      .msg_name = &addr,
+      .msg_namelen = sizeof(addr),
+      .msg_iov = &iov,
+      .msg_iovlen = 1,
+      .msg_control = control,
+      .msg_controllen = sizeof(control),
+    };
+    ssize_t nread;
+    do {
+      nread = recvmsg(fd, &msg, 0);
+    } while (nread < 0 && errno == EINTR);
+    if (nread < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        status = uv_translate_sys_error(errno);
+      }
+      break;
+    }
+    int32_t segment_size = 0;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+        memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(int));
+      }
+    }
+    moonbit_uv_udp_recv_batch_record(
+      batch, batch->used, nread, msg.msg_flags & MSG_TRUNC ? UV_UDP_PARTIAL : 0,
+      segment_size, (struct sockaddr *)&addr
+    );
+    batch->used += nread;
+  }
+  // Datagrams left in a full batch are delivered with the next one, as the
+  // socket is still readable.
+  moonbit_uv_udp_recv_batch_flush(batch, status);
+}
+
+// Receives with `batch->poll` instead of libuv, on a duplicate of the socket,
+// because libuv watches the socket itself to send.
+static inline int
+moonbit_uv_udp_recv_batch_poll_start(moonbit_uv_udp_recv_batch_t *batch) {
+  uv_os_fd_t fd;
+  int status = uv_fileno((uv_handle_t *)&batch->udp->udp, &fd);
+  if (status < 0) {
+    return status;
+  }
+  int poll_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (poll_fd < 0) {
+    return uv_translate_sys_error(errno);
+  }
+  uv_poll_t *poll = (uv_poll_t *)malloc(sizeof(uv_poll_t));
+  if (poll == NULL) {
+    close(poll_fd);
+    return UV_ENOMEM;
+  }
+  status = uv_poll_init(batch->udp->udp.loop, poll, poll_fd);
+  if (status < 0) {
+    free(poll);
+    close(poll_fd);
+    return status;
+  }
+  poll->data = batch;
+  batch->poll = poll;
+  // Enabled once the batch is the receive state of the handle, which turns it
+  // off again when it is replaced.
+  int on = 1;
+  if (setsockopt(poll_fd, SOL_UDP, UDP_GRO, &on, sizeof(on)) < 0) {
+    return uv_translate_sys_error(errno);
+  }
+  batch->udp->gro = true;
+  return uv_poll_start(poll, UV_READABLE, moonbit_uv_udp_recv_batch_poll_cb);
+}
+#endif
+
+static inline void
+moonbit_uv_udp_recv_batch_alloc_cb(
+  uv_handle_t *handle,
+  size_t suggested_size,
+  uv_buf_t *buf
+) {
+  moonbit_uv_ignore(suggested_size);
+  moonbit_uv_udp_recv_batch_t *batch = handle->data;
+  moonbit_uv_udp_recv_batch_prepare(batch);
+  *buf = uv_buf_init(
+    (char *)batch->data + batch->used, batch->size - batch->used
+  );
+}
+
+static inline void
+moonbit_uv_udp_recv_batch_cb(
+  uv_udp_t *udp,
+  ssize_t nread,
+  const uv_buf_t *buf,
+  const struct sockaddr *addr,
+  unsigned flags
+) {
+  moonbit_uv_udp_recv_batch_t *batch = udp->data;
+  if (nread < 0) {
+    // Errors are delivered along with the datagrams received before them.
+    moonbit_uv_udp_recv_batch_flush(batch, nread);
+    return;
+  }
+  if (addr == NULL) {
+    // Either the socket is drained, or libuv is done with the buffer of a
+    // `recvmmsg()` call (`UV_UDP_MMSG_FREE`).
+    moonbit_uv_udp_recv_batch_flush(batch, 0);
+    return;
+  }
+  int32_t offset = buf->base - (char *)batch->data;
+  moonbit_uv_udp_recv_batch_record(
+    batch, offset, nread, flags & ~UV_UDP_MMSG_CHUNK, 0, addr
+  );
+  if (flags & UV_UDP_MMSG_CHUNK) {
+    // The rest of the batch follows, then `UV_UDP_MMSG_FREE`.
+    return;
+  }
+  batch->used = offset + nread;
+  if (batch->count < batch->capacity &&
+      batch->size - batch->used >= MOONBIT_UV_UDP_DGRAM_MAXSIZE) {
+    uv_check_start(batch->flush, moonbit_uv_udp_recv_batch_check_cb);
+    return;
+  }
+  moonbit_uv_udp_recv_batch_flush(batch, 0);
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_udp_recv_start_batch(
+  moonbit_uv_udp_t *udp,
+  int32_t max_batch,
+  bool gro,
+  moonbit_uv_udp_recv_batch_cb_t *cb
+) {
+#ifndef __linux__
+  if (gro) {
+    moonbit_decref(cb);
+    moonbit_decref(udp);
+    return UV_ENOTSUP;
+  }
+#endif
+  moonbit_uv_udp_recv_batch_t *batch =
+    (moonbit_uv_udp_recv_batch_t *)moonbit_make_external_object(
+      moonbit_uv_udp_recv_batch_finalize, sizeof(moonbit_uv_udp_recv_batch_t)
+    );
+  memset(batch, 0, sizeof(moonbit_uv_udp_recv_batch_t));
+  batch->cb = cb;
+  batch->udp = udp;
+  batch->capacity = max_batch;
+  batch->size = max_batch * MOONBIT_UV_UDP_DGRAM_MAXSIZE;
+  uv_check_t *flush = (uv_check_t *)malloc(sizeof(uv_check_t));
+  if (flush == NULL) {
+    moonbit_decref(batch);
+    moonbit_decref(udp);
+    return UV_ENOMEM;
+  }
+  uv_check_init(udp->udp.loop, flush);
+  flush->data = batch;
+  batch->flush = flush;
+  moonbit_uv_udp_set_data(&udp->udp, (moonbit_uv_udp_data_t *)batch);
+  int32_t status;
+#ifdef __linux__
+  if (gro) {
+    status = moonbit_uv_udp_recv_batch_poll_start(batch);
+  } else
+#endif
+  {
+    status = uv_udp_recv_start(
+      &udp->udp, moonbit_uv_udp_recv_batch_alloc_cb,
+      moonbit_uv_udp_recv_batch_cb
+    );
+  }
+  if (status < 0) {
+    moonbit_uv_udp_set_data(&udp->udp, NULL);
+  }
+  moonbit_decref(udp);
+  return status;
+}
+
+MOONBIT_FFI_EXPORT
+struct sockaddr *
+moonbit_uv_udp_recv_batch_addr(moonbit_bytes_t addrs, int32_t index) {
+  struct sockaddr *addr = (struct sockaddr *)moonbit_make_bytes(
+    sizeof(struct sockaddr_storage), 0
+  );
+  memcpy(
+    addr, addrs + index * sizeof(struct sockaddr_storage),
+    sizeof(struct sockaddr_storage)
+  );
+  return addr;
+}
+
 MOONBIT_FFI_EXPORT
 uint32_t
 moonbit_uv_UDP_RECVMMSG() {
@@ -521,6 +1067,120 @@ moonbit_uv_udp_try_send2(
   return result;
 }
 
+// Maximum number of datagrams handed to `uv_udp_try_send2()` at once, which
+// is also the most a single `sendmmsg()` call takes on Linux.
+#define MOONBIT_UV_UDP_SEND_BATCH_MAX 1024
+
+// Sends `count` datagrams of one buffer each, starting from `start`, with as
+// few `sendmmsg()` calls as possible. Returns the number of datagrams sent,
+// or an error if not even the first one could be sent. The arrays are
+// borrowed.
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_udp_try_send_batch(
+  moonbit_uv_udp_t *udp,
+  moonbit_bytes_t *bufs,
+  int32_t *bufs_offset,
+  int32_t *bufs_length,
+  struct sockaddr **addrs,
+  int32_t start,
+  int32_t count
+) {
+  uv_buf_t bufs_data[MOONBIT_UV_UDP_SEND_BATCH_MAX];
+  uv_buf_t *bufs_list[MOONBIT_UV_UDP_SEND_BATCH_MAX];
+  unsigned int nbufs_data[MOONBIT_UV_UDP_SEND_BATCH_MAX];
+  int32_t sent = 0;
+  while (sent < count) {
+    int32_t chunk = count - sent;
+    if (chunk > MOONBIT_UV_UDP_SEND_BATCH_MAX) {
+      chunk = MOONBIT_UV_UDP_SEND_BATCH_MAX;
+    }
+    int32_t first = start + sent;
+    for (int32_t i = 0; i < chunk; i++) {
+      bufs_data[i] = uv_buf_init(
+        (char *)bufs[first + i] + bufs_offset[first + i],
+        bufs_length[first + i]
+      );
+      bufs_list[i] = &bufs_data[i];
+      nbufs_data[i] = 1;
+    }
+    int result = uv_udp_try_send2(
+      &udp->udp, chunk, bufs_list, nbufs_data, addrs + first, 0
+    );
+    if (result < 0) {
+      return sent > 0 ? sent : result;
+    }
+    sent += result;
+    if (result < chunk) {
+      break;
+    }
+  }
+  return sent;
+}
+
+// Sends the concatenation of `bufs` as datagrams of `segment_size` bytes
+// each (the last one may be shorter), segmented by the kernel or the network
+// card (`UDP_SEGMENT`). The arrays are borrowed.
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_udp_try_send_segmented(
+  moonbit_uv_udp_t *udp,
+  moonbit_bytes_t *bufs,
+  int32_t *bufs_offset,
+  int32_t *bufs_length,
+  struct sockaddr *addr,
+  int32_t segment_size
+) {
+#ifdef __linux__
+  // Datagrams queued by `uv_udp_send()` must go first, as with
+  // `uv_udp_try_send()`.
+  if (udp->udp.send_queue_count > 0) {
+    return UV_EAGAIN;
+  }
+  uv_os_fd_t fd;
+  int status = uv_fileno((uv_handle_t *)&udp->udp, &fd);
+  if (status < 0) {
+    return status;
+  }
+  int32_t bufs_size = Moonbit_array_length(bufs);
+  struct iovec *iov = malloc(sizeof(struct iovec) * bufs_size);
+  if (iov == NULL) {
+    return UV_ENOMEM;
+  }
+  for (int32_t i = 0; i < bufs_size; i++) {
+    iov[i].iov_base = (char *)bufs[i] + bufs_offset[i];
+    iov[i].iov_len = bufs_length[i];
+  }
+  char control[CMSG_SPACE(sizeof(uint16_t))];
+  memset(control, 0, sizeof(control));
+  struct msghdr msg = {
+    .msg_name = addr,
+    .msg_namelen = addr ? moonbit_uv_udp_addr_length(addr) : 0,
+    .msg_iov = iov,
+    .msg_iovlen = bufs_size,
+    .msg_control = control,
+    .msg_controllen = sizeof(control),
+  };
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+  uint16_t gso_size = segment_size;
+  memcpy(CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+  ssize_t result;
+  do {
+    result = sendmsg(fd, &msg, 0);
+  } while (result < 0 && errno == EINTR);
+  free(iov);
+  if (result < 0) {
+    return errno == EWOULDBLOCK ? UV_EAGAIN : uv_translate_sys_error(errno);
+  }
+  return result;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
 MOONBIT_FFI_EXPORT
 int32_t
 moonbit_uv_udp_using_recvmmsg(moonbit_uv_udp_t *udp) {
@@ -34,6 +34,7 @@
 
 #include "args.c"
 #include "async.c"
+#include "buffer_pool.c"
 #include "bytes.c"
 #include "check.c"
 #include "cond.c"
@@ -44,12 +45,15 @@
 #include "fs.c"
 #include "fs_event.c"
 #include "fs_poll.c"
+#include "fs_walk.c"
 #include "handle.c"
 #include "idle.c"
 #include "if.c"
 #include "library.c"
 #include "loop.c"
+#include "mapped_file.c"
 #include "metrics.c"
+#include "multi_loop.c"
 #include "mutex.c"
 #include "os.c"
 #include "passwd.c"
@@ -59,6 +63,7 @@
 #include "process.c"
 #include "random.c"
 #include "req.c"
+#include "req_pool.c"
 #include "rusage.c"
 #include "rwlock.c"
 #include "sem.c"
@@ -66,6 +71,7 @@
 #include "socket.c"
 #include "stat.c"
 #include "stream.c"
+#include "stream_stats.c"
 #include "string.c"
 #include "tcp.c"
 #include "thread.c"
@@ -14,9 +14,15 @@
  * limitations under the License.
  */
 
+#include "stream.h"
 #include "uv#include#uv.h"
 #include "uv.h"
+#include <stdbool.h>
 #include <stdlib.h>
+#ifdef __linux__
+#include <errno.h>
+#include <sys/sendfile.h>
+#endif
 
 typedef struct moonbit_uv_write_s {
   uv_write_t write;
@@ -52,16 +58,11 @@ typedef struct moonbit_uv_write_cb {
 typedef struct moonbit_uv_write_data_s {
   moonbit_uv_write_cb_t *cb;
   moonbit_bytes_t *bufs;
+  // Only set while the loop of the stream keeps traffic counters.
+  uint64_t bytes;
+  uint64_t queued_at;
 } moonbit_uv_write_data_t;
 
-static inline void
-moonbit_uv_write_cb(uv_write_t *req, int status) {
-  moonbit_uv_write_data_t *data = req->data;
-  moonbit_uv_write_cb_t *cb = data->cb;
-  data->cb = NULL;
-  moonbit_uv_write_t *write = containerof(req, moonbit_uv_write_t, write);
-  cb->code(cb, write, status);
-}
 
 static inline void
 moonbit_uv_write_data_finalize(void *object) {
@@ -95,6 +96,83 @@ moonbit_uv_write_set_data(
   req->write.data = data;
 }
 
+MOONBIT_FFI_EXPORT
+moonbit_uv_write_t *
+moonbit_uv_write_acquire(uv_stream_t *handle) {
+  moonbit_uv_loop_data_t *data = moonbit_uv_loop_data(handle->loop);
+  moonbit_uv_write_t *write =
+    data ? moonbit_uv_req_pool_acquire(&data->write_pool) : NULL;
+  return write ? write : moonbit_uv_write_make();
+}
+
+// Resets `write`, whose callback has returned, and gives it back to the pool
+// of `loop` if nothing else references it. Its data object is kept for the
+// next write when it is not referenced either.
+static inline void
+moonbit_uv_write_recycle(moonbit_uv_write_t *write, uv_loop_t *loop) {
+  if (loop->data) {
+    moonbit_uv_req_pool_t *pool =
+      &((moonbit_uv_loop_data_t *)loop->data)->write_pool;
+    if (moonbit_uv_req_pool_recyclable(pool, write)) {
+      moonbit_uv_write_data_t *data = write->write.data;
+      if (data && Moonbit_object_header(data)->rc == 1 && data->cb == NULL) {
+        if (data->bufs) {
+          moonbit_decref(data->bufs);
+        }
+        memset(data, 0, sizeof(moonbit_uv_write_data_t));
+      } else if (data) {
+        moonbit_decref(data);
+        data = NULL;
+      }
+      memset(&write->write, 0, sizeof(uv_write_t));
+      write->write.data = data;
+      moonbit_uv_req_pool_release(pool, write);
+      return;
+    }
+  }
+  moonbit_decref(write);
+}
+
+static inline void
+moonbit_uv_write_cb(uv_write_t *req, int status) {
+  moonbit_uv_write_data_t *data = req->data;
+  moonbit_uv_write_cb_t *cb = data->cb;
+  data->cb = NULL;
+  moonbit_uv_stream_stats_record_written(
+    req->handle, data->bytes, status, data->queued_at
+  );
+  uv_loop_t *loop = req->handle->loop;
+  moonbit_uv_write_t *write = containerof(req, moonbit_uv_write_t, write);
+  moonbit_incref(write);
+  cb->code(cb, write, status);
+  moonbit_uv_write_recycle(write, loop);
+}
+
+// Returns the data object of `req`, left by a previous write if `req` was
+// recycled, or a new one.
+static inline moonbit_uv_write_data_t *
+moonbit_uv_write_data_of(moonbit_uv_write_t *req) {
+  if (req->write.data == NULL) {
+    moonbit_uv_write_set_data(req, moonbit_uv_write_data_make());
+  }
+  return req->write.data;
+}
+
+static inline void
+moonbit_uv_write_data_record_queued(
+  moonbit_uv_write_data_t *data,
+  uv_stream_t *handle,
+  const uv_buf_t *bufs,
+  int bufs_size
+) {
+  data->queued_at = moonbit_uv_stream_stats_record_queued(handle);
+  if (data->queued_at) {
+    for (int i = 0; i < bufs_size; i++) {
+      data->bytes += bufs[i].len;
+    }
+  }
+}
+
 MOONBIT_FFI_EXPORT
 int32_t
 moonbit_uv_write(
@@ -111,12 +189,14 @@ moonbit_uv_write(
     bufs_data[i] =
       uv_buf_init((char *)bufs[i] + bufs_offset[i], bufs_length[i]);
   }
-  moonbit_uv_write_data_t *data = moonbit_uv_write_data_make();
+  moonbit_uv_write_data_t *data = moonbit_uv_write_data_of(req);
   data->bufs = bufs;
   data->cb = cb;
-  moonbit_uv_write_set_data(req, data);
   int result =
     uv_write(&req->write, handle, bufs_data, bufs_size, moonbit_uv_write_cb);
+  if (result == 0) {
+    moonbit_uv_write_data_record_queued(data, handle, bufs_data, bufs_size);
+  }
   free(bufs_data);
   moonbit_decref(handle);
   moonbit_decref(bufs_offset);
@@ -141,13 +221,15 @@ moonbit_uv_write2(
     bufs_data[i] =
       uv_buf_init((char *)bufs[i] + bufs_offset[i], bufs_length[i]);
   }
-  moonbit_uv_write_data_t *data = moonbit_uv_write_data_make();
+  moonbit_uv_write_data_t *data = moonbit_uv_write_data_of(req);
   data->bufs = bufs;
   data->cb = cb;
-  moonbit_uv_write_set_data(req, data);
   int result = uv_write2(
     &req->write, handle, bufs_data, bufs_size, send_handle, moonbit_uv_write_cb
   );
+  if (result == 0) {
+    moonbit_uv_write_data_record_queued(data, handle, bufs_data, bufs_size);
+  }
   free(bufs_data);
   moonbit_decref(handle);
   moonbit_decref(bufs_offset);
@@ -155,3 +237,311 @@ moonbit_uv_write2(
   moonbit_decref(send_handle);
   return result;
 }
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_try_write(
+  moonbit_uv_write_t *req,
+  uv_stream_t *handle,
+  moonbit_bytes_t *bufs,
+  int32_t *bufs_offset,
+  int32_t *bufs_length,
+  moonbit_uv_write_cb_t *cb
+) {
+  int bufs_size = Moonbit_array_length(bufs);
+  uv_buf_t *bufs_data = malloc(sizeof(uv_buf_t) * bufs_size);
+  for (int i = 0; i < bufs_size; i++) {
+    bufs_data[i] =
+      uv_buf_init((char *)bufs[i] + bufs_offset[i], bufs_length[i]);
+  }
+  int result = uv_try_write(handle, bufs_data, bufs_size);
+  moonbit_uv_stream_stats_record_try_write(handle, result);
+  free(bufs_data);
+  moonbit_decref(handle);
+  moonbit_decref(bufs);
+  moonbit_decref(bufs_offset);
+  moonbit_decref(bufs_length);
+  if (result >= 0) {
+    // `uv_try_write()` is synchronous, so the write is complete by now.
+    cb->code(cb, req, 0);
+  } else {
+    moonbit_decref(req);
+    moonbit_decref(cb);
+  }
+  return result;
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_try_write2(
+  moonbit_uv_write_t *req,
+  uv_stream_t *handle,
+  moonbit_bytes_t *bufs,
+  int32_t *bufs_offset,
+  int32_t *bufs_length,
+  uv_stream_t *send_handle,
+  moonbit_uv_write_cb_t *cb
+) {
+  int bufs_size = Moonbit_array_length(bufs);
+  uv_buf_t *bufs_data = malloc(sizeof(uv_buf_t) * bufs_size);
+  for (int i = 0; i < bufs_size; i++) {
+    bufs_data[i] =
+      uv_buf_init((char *)bufs[i] + bufs_offset[i], bufs_length[i]);
+  }
+  int result = uv_try_write2(handle, bufs_data, bufs_size, send_handle);
+  moonbit_uv_stream_stats_record_try_write(handle, result);
+  free(bufs_data);
+  moonbit_decref(handle);
+  moonbit_decref(bufs);
+  moonbit_decref(bufs_offset);
+  moonbit_decref(bufs_length);
+  moonbit_decref(send_handle);
+  if (result >= 0) {
+    cb->code(cb, req, 0);
+  } else {
+    moonbit_decref(req);
+    moonbit_decref(cb);
+  }
+  return result;
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_try_write_view(
+  uv_stream_t *handle,
+  moonbit_bytes_t buf,
+  int32_t buf_offset,
+  int32_t buf_length
+) {
+  uv_buf_t bufs[1] = {uv_buf_init((char *)buf + buf_offset, buf_length)};
+  int result = uv_try_write(handle, bufs, 1);
+  moonbit_uv_stream_stats_record_try_write(handle, result);
+  return result;
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_try_write_views(
+  uv_stream_t *handle,
+  moonbit_bytes_t buf0,
+  int32_t buf0_offset,
+  int32_t buf0_length,
+  moonbit_bytes_t buf1,
+  int32_t buf1_offset,
+  int32_t buf1_length
+) {
+  uv_buf_t bufs[2] = {
+    uv_buf_init((char *)buf0 + buf0_offset, buf0_length),
+    uv_buf_init((char *)buf1 + buf1_offset, buf1_length),
+  };
+  int result = uv_try_write(handle, bufs, 2);
+  moonbit_uv_stream_stats_record_try_write(handle, result);
+  return result;
+}
+
+// Size of the buffer used when the file cannot be sent with sendfile(2).
+#define MOONBIT_UV_WRITE_FILE_CHUNK_SIZE 65536
+
+// Number of bytes copied through the buffer when the socket is full, only to
+// be notified once it can take more data.
+#define MOONBIT_UV_WRITE_FILE_PROBE_SIZE 4096
+
+typedef struct moonbit_uv_write_file_cb {
+  int32_t (*code)(
+    struct moonbit_uv_write_file_cb *,
+    int32_t status,
+    uint64_t sent
+  );
+} moonbit_uv_write_file_cb_t;
+
+typedef struct moonbit_uv_write_file_s {
+  uv_write_t req;
+  // Reads the file into `chunk` when it is copied through the stream.
+  uv_fs_t fs;
+  uv_stream_t *stream;
+  moonbit_uv_write_file_cb_t *cb;
+  uv_file file;
+  int64_t offset;
+  uint64_t remaining;
+  uint64_t sent;
+  // Length of the data in `chunk` being written by `req`.
+  size_t length;
+  // Set once sendfile(2) turned out not to work for this stream.
+  bool copy;
+  // Allocated the first time the file is copied through the stream, which
+  // does not happen at all when sendfile(2) does all the work.
+  char *chunk;
+} moonbit_uv_write_file_t;
+
+static inline void
+moonbit_uv_write_file_complete(
+  moonbit_uv_write_file_t *write_file,
+  int32_t status
+) {
+  moonbit_uv_write_file_cb_t *cb = write_file->cb;
+  uint64_t sent = write_file->sent;
+  moonbit_decref(write_file->stream);
+  free(write_file->chunk);
+  free(write_file);
+  cb->code(cb, status, sent);
+}
+
+static inline void
+moonbit_uv_write_file_send(moonbit_uv_write_file_t *write_file);
+
+static inline void
+moonbit_uv_write_file_chunk_cb(uv_write_t *req, int status) {
+  moonbit_uv_write_file_t *write_file =
+    containerof(req, moonbit_uv_write_file_t, req);
+  if (status < 0) {
+    moonbit_uv_write_file_complete(write_file, status);
+    return;
+  }
+  write_file->offset += write_file->length;
+  write_file->remaining -= write_file->length;
+  write_file->sent += write_file->length;
+  moonbit_uv_write_file_send(write_file);
+}
+
+static inline void
+moonbit_uv_write_file_read_cb(uv_fs_t *fs) {
+  moonbit_uv_write_file_t *write_file =
+    containerof(fs, moonbit_uv_write_file_t, fs);
+  ssize_t result = fs->result;
+  uv_fs_req_cleanup(fs);
+  if (result <= 0) {
+    // An empty read means that the file is shorter than requested.
+    moonbit_uv_write_file_complete(write_file, result);
+    return;
+  }
+  write_file->length = result;
+  uv_buf_t buf = uv_buf_init(write_file->chunk, result);
+  int status = uv_write(
+    &write_file->req, write_file->stream, &buf, 1,
+    moonbit_uv_write_file_chunk_cb
+  );
+  if (status < 0) {
+    moonbit_uv_write_file_complete(write_file, status);
+  }
+}
+
+// Reads the next `size` bytes of the file into `chunk` on the threadpool,
+// then writes them with a regular write request that completes once the
+// stream has taken them. Returns 0 if the read was queued, or an error.
+static inline int
+moonbit_uv_write_file_copy(moonbit_uv_write_file_t *write_file, size_t size) {
+  if (write_file->chunk == NULL) {
+    write_file->chunk = malloc(MOONBIT_UV_WRITE_FILE_CHUNK_SIZE);
+    if (write_file->chunk == NULL) {
+      return UV_ENOMEM;
+    }
+  }
+  if (size > write_file->remaining) {
+    size = write_file->remaining;
+  }
+  uv_buf_t buf = uv_buf_init(write_file->chunk, size);
+  return uv_fs_read(
+    write_file->stream->loop, &write_file->fs, write_file->file, &buf, 1,
+    write_file->offset, moonbit_uv_write_file_read_cb
+  );
+}
+
+static inline void
+moonbit_uv_write_file_send(moonbit_uv_write_file_t *write_file) {
+#ifdef __linux__
+  uv_os_fd_t fd;
+  if (uv_fileno((uv_handle_t *)write_file->stream, &fd) < 0) {
+    write_file->copy = true;
+  }
+  while (!write_file->copy && write_file->remaining > 0) {
+    off_t offset = write_file->offset;
+    size_t count = write_file->remaining > SSIZE_MAX ? SSIZE_MAX
+                                                     : write_file->remaining;
+    ssize_t result = sendfile(fd, write_file->file, &offset, count);
+    if (result > 0) {
+      write_file->offset += result;
+      write_file->remaining -= result;
+      write_file->sent += result;
+    } else if (result == 0) {
+      // The file is shorter than requested.
+      write_file->remaining = 0;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      // The socket is full. A small write through the stream tells when it
+      // drains, after which sendfile(2) takes over again.
+      int status = moonbit_uv_write_file_copy(
+        write_file, MOONBIT_UV_WRITE_FILE_PROBE_SIZE
+      );
+      if (status < 0) {
+        moonbit_uv_write_file_complete(write_file, status);
+      }
+      return;
+    } else if (errno == EINVAL || errno == ENOSYS) {
+      // Not supported for this pair of descriptors.
+      write_file->copy = true;
+    } else if (errno != EINTR) {
+      moonbit_uv_write_file_complete(write_file, uv_translate_sys_error(errno));
+      return;
+    }
+  }
+#else
+  write_file->copy = true;
+#endif
+  if (write_file->remaining == 0) {
+    moonbit_uv_write_file_complete(write_file, 0);
+    return;
+  }
+  int status =
+    moonbit_uv_write_file_copy(write_file, MOONBIT_UV_WRITE_FILE_CHUNK_SIZE);
+  if (status < 0) {
+    moonbit_uv_write_file_complete(write_file, status);
+  }
+}
+
+static inline void
+moonbit_uv_write_file_drain_cb(uv_write_t *req, int status) {
+  moonbit_uv_write_file_t *write_file =
+    containerof(req, moonbit_uv_write_file_t, req);
+  if (status < 0) {
+    moonbit_uv_write_file_complete(write_file, status);
+    return;
+  }
+  moonbit_uv_write_file_send(write_file);
+}
+
+MOONBIT_FFI_EXPORT
+int32_t
+moonbit_uv_write_file(
+  uv_stream_t *stream,
+  int32_t file,
+  int64_t offset,
+  uint64_t length,
+  moonbit_uv_write_file_cb_t *cb
+) {
+  moonbit_uv_write_file_t *write_file = malloc(sizeof(moonbit_uv_write_file_t));
+  if (write_file == NULL) {
+    moonbit_decref(stream);
+    moonbit_decref(cb);
+    return UV_ENOMEM;
+  }
+  write_file->stream = stream;
+  write_file->cb = cb;
+  write_file->file = file;
+  write_file->offset = offset;
+  write_file->remaining = length;
+  write_file->sent = 0;
+  write_file->length = 0;
+  write_file->copy = false;
+  write_file->chunk = NULL;
+  // An empty write completes once the writes queued before it are done, at
+  // which point the file can be sent directly to the socket.
+  uv_buf_t buf = uv_buf_init(NULL, 0);
+  int status = uv_write(
+    &write_file->req, stream, &buf, 1, moonbit_uv_write_file_drain_cb
+  );
+  if (status < 0) {
+    free(write_file);
+    moonbit_decref(stream);
+    moonbit_decref(cb);
+  }
+  return status;
+}